@@ -27,18 +27,74 @@
 
 #pragma once
 
-#include "PathFinder_API.h"
+#include "pathfinder_api.h"
 
+#include <cstdint>
 #include <filesystem>
+#include <span>
 #include <string_view>
 
 /// \n
 namespace pathfinder
 {
 
+///	\brief Non-owning view of a path in its native representation.
+struct path_view
+{
+	using value_type = std::filesystem::path::value_type;
+
+	value_type const* data = nullptr; //!< Null terminated, unless empty
+	uintptr_t         size = 0;
+
+	inline std::basic_string_view<value_type> native() const { return std::basic_string_view<value_type>{data, size}; }
+	inline bool empty() const { return size == 0; }
+};
+
 ///	\brief Use this function to retrieve a path in the file system that should be used for a given category
 ///	\param[in] p_category - The name of path category
 ///	\return A path. If the path category was not found the returning path will be empty.
+///	\note The returned reference stays valid across reloads, until the calling thread has looked up paths in 4 newer tables,
+///		calls \ref path_quiescent or exits. Expressions such as f(path_find(a), path_find(b)) are therefore safe during a reload,
+///		see CHANGELOG.md. Use \ref path_acquire to keep a path for longer.
+///		Each thread remembers the categories it found last by the address of \p p_category,
+///		calling this repeatedly with the same string skips the lookup until the next load.
 pathfinder_API const std::filesystem::path& path_find(std::u8string_view p_category);
 
+///	\brief Same as \ref path_find, but does not require a std::filesystem::path object to exist.
+///	\note When the table is served from a mapped cache (see LoadFlag::MapCache) this does not allocate.
+///		The same lifetime rules as \ref path_find apply.
+pathfinder_API path_view path_find_view(std::u8string_view p_category);
+
+///	\brief Same as \ref path_find, but returns the path in UTF-8.
+///	\return Null terminated, empty if the category was not found.
+///	\note Does not allocate, the UTF-8 form is computed once per entry. The same lifetime rules as \ref path_find apply.
+pathfinder_API std::u8string_view path_find_u8(std::u8string_view p_category);
+
+///	\brief Same as \ref path_find_view, for callers that only need the null terminated native string.
+///	\return Never nullptr, an empty string if the category was not found.
+pathfinder_API path_view::value_type const* path_find_cstr(std::u8string_view p_category);
+
+///	\brief Descriptor of the directory of a category, for use with openat, statx and other *at calls relative to it.
+///	\return -1 if the category was not found, the directory could not be opened, or if not supported (Linux only).
+///	\note The directory is opened with O_PATH on first request and kept open by the loaded table,
+///		a reload opens it again on first request. The descriptor must not be closed by the caller,
+///		the same lifetime rules as \ref path_find apply.
+pathfinder_API int path_find_dirfd(std::u8string_view p_category);
+
+///	\brief Resolves several path categories in one call.
+///	\param[in] p_categories - The names of the path categories
+///	\param[out] p_paths - Receives the path of each category, categories not found receive an empty path.
+///		Must be at least as large as p_categories.
+///	\param[out] p_missed - Optional bitmap, bit i is set if p_categories[i] was not found.
+///		If not empty it must have at least (p_categories.size() + 63) / 64 words.
+///	\return Number of categories that were not found.
+///	\note The same lifetime rules as \ref path_find apply to the returned paths.
+pathfinder_API uintptr_t path_find_many(std::span<const std::u8string_view> p_categories, std::span<const std::filesystem::path*> p_paths, std::span<uint64_t> p_missed = {});
+
+///	\brief Declares that the calling thread no longer holds references obtained from \ref path_find.
+///	\note A table replaced by a reload is freed once no thread that looked it up recently is still holding it,
+///		a thread lets go of it once it looked up paths in 4 newer tables, when it calls this function or exits.
+///		Threads that stop looking paths up for a while should call it, so that they do not keep a replaced table alive meanwhile.
+pathfinder_API void path_quiescent();
+
 } //namespace pathfinder
@@ -0,0 +1,78 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+///	\file
+///	\brief Plain C interface, for callers that can not use the C++ one.
+///	\note The same lifetime rules as pathfinder::path_find apply to every string returned,
+///		they stay valid across reloads until the calling thread has looked up strings in 4 newer tables,
+///		or until it calls \ref pathfinder_quiescent or exits.
+
+#include "pathfinder_api.h"
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#ifdef _WIN32
+typedef wchar_t pathfinder_os_char;
+#else
+typedef char pathfinder_os_char;
+#endif
+
+///	\brief UTF-8 string, null terminated. Never null.
+typedef struct pathfinder_u8_string
+{
+	char const* data;
+	uintptr_t   size;
+} pathfinder_u8_string;
+
+///	\brief String in the native encoding of the system, null terminated. Never null.
+typedef struct pathfinder_os_string
+{
+	pathfinder_os_char const* data;
+	uintptr_t                 size;
+} pathfinder_os_string;
+
+///	\brief Path of a category in UTF-8, empty if not found.
+///	\param[in] p_category - UTF-8 name of the category, does not need to be null terminated
+///	\param[in] p_size - Size of \p p_category in bytes
+pathfinder_API pathfinder_u8_string pathfinder_find_u8(char const* p_category, uintptr_t p_size);
+
+///	\brief Path of a category in the native encoding, empty if not found.
+pathfinder_API pathfinder_os_string pathfinder_find_native(char const* p_category, uintptr_t p_size);
+
+///	\brief Same as pathfinder::path_quiescent
+pathfinder_API void pathfinder_quiescent(void);
+
+#ifdef __cplusplus
+} //extern "C"
+#endif
@@ -0,0 +1,113 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include "pathfinder_api.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+/// \n
+namespace pathfinder
+{
+
+///	\brief Hash used to index path categories (64bit FNV-1a).
+///	\note Must match the hash the path table is built with.
+constexpr uint64_t category_hash(std::u8string_view const p_category)
+{
+	uint64_t res = 0xCBF29CE484222325;
+	for(char8_t const tchar : p_category)
+	{
+		res = (res ^ static_cast<uint8_t>(tchar)) * 0x00000100000001B3;
+	}
+	return res;
+}
+
+///	\brief Remembers where a category was found in the currently loaded table.
+///	\note Opaque, the slot is re-evaluated whenever a different table is loaded.
+struct category_binding
+{
+	std::atomic<uint64_t> generation = 0; //!< Generation of the table index was found in
+	std::atomic<uint32_t> index      = 0;
+};
+
+///	\brief Same as \ref path_find but skips hashing, and after the first call skips the lookup as well.
+///	\param[in] p_category - The name of path category
+///	\param[in] p_hash - \ref category_hash of p_category
+///	\param[in, out] p_binding - Binding associated with p_category
+pathfinder_API const std::filesystem::path& path_find(std::u8string_view p_category, uint64_t p_hash, category_binding& p_binding);
+
+
+template<uintptr_t N>
+struct category_name
+{
+	consteval category_name(char8_t const (&p_name)[N]) { std::copy_n(p_name, N, data); }
+	constexpr std::u8string_view view() const { return std::u8string_view{data, N - 1}; }
+
+	char8_t data[N];
+};
+
+///	\brief Compile time path category.
+///	\example pathfinder::category<u8"logs">::path()
+template<category_name Name>
+class category
+{
+public:
+	static constexpr std::u8string_view name = Name.view();
+	static constexpr uint64_t hash = category_hash(name);
+
+	static inline const std::filesystem::path& path() { return path_find(name, hash, s_binding); }
+
+private:
+	static inline category_binding s_binding;
+};
+
+///	\brief Run time equivalent of \ref category, for names only known at startup.
+class interned_category
+{
+public:
+	inline explicit interned_category(std::u8string_view const p_name)
+		: m_name{p_name}
+		, m_hash{category_hash(p_name)}
+	{
+	}
+
+	inline const std::filesystem::path& path() const { return path_find(m_name, m_hash, m_binding); }
+	inline std::u8string_view name() const { return m_name; }
+
+private:
+	std::u8string const      m_name;
+	uint64_t const           m_hash;
+	mutable category_binding m_binding;
+};
+
+} //namespace pathfinder
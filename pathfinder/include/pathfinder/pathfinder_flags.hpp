@@ -0,0 +1,72 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include <cstdint>
+#include <type_traits>
+
+/// \n
+namespace pathfinder
+{
+
+enum class LoadFlag: uint32_t
+{
+	None        = 0x0000,
+	///	Load from the compiled cache next to the file if its size and modification time did not change, otherwise parse the file and (re)write the cache.
+	///	Only size and modification time are trusted, on file systems with a coarse modification time or after an edit that kept both a stale cache is served, see VerifyCache.
+	///	If a cache can not be written, no other cache is written to its directory for the rest of the process.
+	UseCache    = 0x0001,
+	MapCache    = 0x0003, //!< Same as UseCache, but serves lookups straight out of a read-only mapping of the cache
+	VerifyCache = 0x0005, //!< Same as UseCache, but the content of the file is hashed as well, for file systems where the modification time can not be trusted
+	Lazy        = 0x0010, //!< Only validate keys when loading, values are resolved on first use or by resolve_all_pathfinder. A value that fails to resolve still defines its key, with an empty path. The cache is read but not written
+	Profile     = 0x0020, //!< Also time each phase of resolving the values, see PathFinder::load_stats. Costs a few clock reads per value
+	Watch       = 0x0100, //!< Reload automatically when the file changes on disk, only acted upon by the pathfinder service
+};
+
+inline constexpr LoadFlag operator | (LoadFlag const p_1, LoadFlag const p_2)
+{
+	return static_cast<LoadFlag>(static_cast<std::underlying_type_t<LoadFlag>>(p_1) | static_cast<std::underlying_type_t<LoadFlag>>(p_2));
+}
+
+inline constexpr LoadFlag operator & (LoadFlag const p_1, LoadFlag const p_2)
+{
+	return static_cast<LoadFlag>(static_cast<std::underlying_type_t<LoadFlag>>(p_1) & static_cast<std::underlying_type_t<LoadFlag>>(p_2));
+}
+
+///	\brief Whether any bit of \p p_flag is set, use \ref has_all_flags for flags that imply others such as \ref LoadFlag::MapCache
+inline constexpr bool has_flag(LoadFlag const p_flags, LoadFlag const p_flag)
+{
+	return (p_flags & p_flag) != LoadFlag::None;
+}
+
+inline constexpr bool has_all_flags(LoadFlag const p_flags, LoadFlag const p_flag)
+{
+	return (p_flags & p_flag) == p_flag;
+}
+
+} //namespace pathfinder
@@ -0,0 +1,109 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include "pathfinder_api.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+
+/// \n
+namespace pathfinder
+{
+
+class path_handle;
+
+///	\brief Same as \ref path_find, but returns a handle that keeps the path alive.
+///	\note Acquiring is as expensive as \ref path_find, long lived components should keep the handle
+///		and only \ref path_handle::refresh it instead of looking the category up on each use.
+pathfinder_API path_handle path_acquire(std::u8string_view p_category);
+
+///	\brief Number of the currently published table, changes every time a table is loaded, reloaded or cleared.
+pathfinder_API uint64_t path_generation();
+
+///	\brief Owning reference to the path of a category, obtained with \ref path_acquire.
+///	\note The path stays valid for as long as the handle exists, across reloads and \ref clear_pathfinder,
+///		and regardless of \ref path_quiescent. A handle is not updated by reloads, see \ref changed and \ref refresh.
+class path_handle
+{
+public:
+	path_handle() = default;
+
+	///	\brief Path of the category when the handle was acquired, empty if it was not found.
+	inline const std::filesystem::path& path() const { return m_path ? *m_path : s_emptyPath; }
+	inline std::u8string_view name() const { return m_name; }
+	inline bool found() const { return m_path != nullptr; }
+
+	///	\brief Generation of the table the handle was acquired from, see \ref path_generation.
+	inline uint64_t generation() const { return m_generation; }
+
+	///	\brief Whether a different table was published since the handle was acquired.
+	///	\note The path may still be the same, a reload does not necessarily change every category.
+	inline bool changed() const;
+
+	///	\brief Acquires the category again if the table \ref changed.
+	///	\return true if the handle was acquired again.
+	inline bool refresh();
+
+	///	\brief Lets go of the path, the handle no longer refers to any category.
+	inline void release()
+	{
+		m_path.reset();
+		m_name.clear();
+		m_generation = 0;
+	}
+
+private:
+	std::shared_ptr<std::filesystem::path const> m_path;
+	std::u8string m_name;
+	uint64_t      m_generation = 0;
+
+	static inline std::filesystem::path const s_emptyPath;
+
+	friend path_handle path_acquire(std::u8string_view p_category);
+};
+
+inline bool path_handle::changed() const
+{
+	return path_generation() != m_generation;
+}
+
+inline bool path_handle::refresh()
+{
+	if(!changed())
+	{
+		return false;
+	}
+	*this = path_acquire(m_name);
+	return true;
+}
+
+} //namespace pathfinder
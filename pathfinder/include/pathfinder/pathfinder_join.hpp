@@ -0,0 +1,140 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include "pathfinder_api.h"
+#include "pathfinder.hpp"
+
+#include <array>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+/// \n
+namespace pathfinder
+{
+
+using native_char = path_view::value_type;
+using native_string_view = std::basic_string_view<native_char>;
+
+enum class join_status: uint8_t
+{
+	Ok,
+	NotFound, //!< The category was not found, nothing was written
+	Overflow, //!< The output is too small, nothing was written
+	Invalid,  //!< A UTF-8 segment could not be converted to the native encoding, nothing was written
+};
+
+struct join_result
+{
+	join_status status;
+	uintptr_t   size; //!< Size of the path excluding the null terminator, on Overflow the size that would be required
+
+	inline bool ok() const { return status == join_status::Ok; }
+};
+
+///	\brief Relative segment of a path, either in the native encoding or in UTF-8.
+///	\note Only refers to the characters, they must outlive the call the segment is given to.
+class path_segment
+{
+public:
+	constexpr path_segment() = default;
+	constexpr path_segment(native_string_view const p_native): m_native{p_native} {}
+	constexpr path_segment(native_char const* const p_native): m_native{p_native} {}
+	inline path_segment(std::basic_string<native_char> const& p_native): m_native{p_native} {}
+	inline path_segment(std::filesystem::path const& p_path): m_native{p_path.native()} {}
+
+	constexpr path_segment(std::u8string_view const p_u8): m_u8{p_u8}, m_isU8{true} {}
+	constexpr path_segment(char8_t const* const p_u8): m_u8{p_u8}, m_isU8{true} {}
+	inline path_segment(std::u8string const& p_u8): m_u8{p_u8}, m_isU8{true} {}
+
+	constexpr bool is_u8() const { return m_isU8; }
+	constexpr native_string_view native() const { return m_native; }
+	constexpr std::u8string_view u8() const { return m_u8; }
+
+private:
+	native_string_view m_native;
+	std::u8string_view m_u8;
+	bool               m_isU8 = false;
+};
+
+///	\brief Writes the path of \p p_category followed by \p p_segments into \p p_out, without any heap allocation.
+///	\param[in] p_category - The name of path category
+///	\param[out] p_out - Receives the null terminated path, requires room for \ref join_result::size + 1 characters.
+///		Unless the status is Ok it receives an empty string, if it has room for it.
+///	\param[in] p_segments - Relative segments, joined with the preferred separator. Empty segments are skipped.
+///		UTF-8 segments are converted on Windows, and copied as they are elsewhere.
+pathfinder_API join_result path_join(std::u8string_view p_category, std::span<native_char> p_out, std::span<path_segment const> p_segments);
+
+///	\brief Same as above, segments are anything \ref path_segment can be constructed from.
+///	\example pathfinder::path_join(u8"spool", buffer, u8"jobs", job.filename(), u8"data.bin")
+template<typename... Segments>
+	requires (std::is_constructible_v<path_segment, Segments const&> && ...)
+inline join_result path_join(std::u8string_view const p_category, std::span<native_char> const p_out, Segments const&... p_segments)
+{
+	std::array<path_segment, sizeof...(Segments)> const segments{path_segment{p_segments}...};
+	return path_join(p_category, p_out, std::span<path_segment const>{segments});
+}
+
+///	\brief Path stored inline with a fixed capacity, for composing paths on the stack.
+///	\tparam Capacity - Maximum size in characters, excluding the null terminator
+template<uintptr_t Capacity>
+class fixed_path
+{
+public:
+	fixed_path() = default;
+	fixed_path(fixed_path const&) = default;
+	fixed_path& operator = (fixed_path const&) = default;
+
+	///	\brief Replaces the content by the path of \p p_category followed by \p p_segments, see \ref path_join.
+	///	\note Unless the status is Ok the path is left empty.
+	template<typename... Segments>
+	inline join_result assign(std::u8string_view const p_category, Segments const&... p_segments)
+	{
+		join_result const res = path_join(p_category, std::span<native_char>{m_data}, p_segments...);
+		m_size = res.ok() ? res.size : 0;
+		return res;
+	}
+
+	inline native_char const* c_str() const { return m_data; }
+	inline native_string_view native() const { return native_string_view{m_data, m_size}; }
+	inline path_view view() const { return path_view{.data = m_data, .size = m_size}; }
+	inline uintptr_t size() const { return m_size; }
+	inline bool empty() const { return m_size == 0; }
+
+	static constexpr uintptr_t capacity() { return Capacity; }
+
+private:
+	native_char m_data[Capacity + 1] = {};
+	uintptr_t   m_size = 0;
+};
+
+} //namespace pathfinder
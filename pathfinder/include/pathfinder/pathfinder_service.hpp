@@ -27,9 +27,15 @@
 
 #pragma once
 
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
+#include <future>
+#include <string>
+#include <vector>
 
 #include "pathfinder_api.h"
+#include "pathfinder_flags.hpp"
 
 
 /// \n
@@ -37,8 +43,96 @@ namespace pathfinder
 {
 
 class Log_proxy;
+class Environment; //!< See pathfinderLib/pathfinder_environment.hpp
+
+///	\brief Loads the categories in \p p_file on top of the ones already loaded.
+///	\note The new table is built on the side and published atomically, \ref path_find never observes a partial load.
+///		With \ref LoadFlag::Watch every file loaded since the last reload is loaded again when \p p_file changes,
+///		those loads report to the handler set with \ref set_watch_log_handler. \p p_logHandler is not used after the call returns.
+pathfinder_API bool load_pathfinder	(const std::filesystem::path& p_file, Log_proxy& p_logHandler, LoadFlag p_flags = LoadFlag{});
+
+///	\brief Same as above, but the values are expanded with \p p_environment rather than with the process environment.
+///	\note A copy of \p p_environment is kept, reloads triggered by \ref LoadFlag::Watch expand the values of this file with it as well.
+pathfinder_API bool load_pathfinder	(const std::filesystem::path& p_file, Log_proxy& p_logHandler, LoadFlag p_flags, Environment const& p_environment);
+
+///	\brief Replaces the currently loaded categories with the ones in \p p_file.
+///	\note If loading fails the current table is kept.
+///		Stops watching the files previously loaded, see \ref load_pathfinder for \ref LoadFlag::Watch.
+pathfinder_API bool reload_pathfinder	(const std::filesystem::path& p_file, Log_proxy& p_logHandler, LoadFlag p_flags = LoadFlag{});
+
+///	\brief Same as above, see \ref load_pathfinder for \p p_environment.
+pathfinder_API bool reload_pathfinder	(const std::filesystem::path& p_file, Log_proxy& p_logHandler, LoadFlag p_flags, Environment const& p_environment);
+
+///	\brief How lookups behave while a load started with \ref load_pathfinder_async is in progress.
+enum class AsyncMode: uint8_t
+{
+	Stale, //!< Lookups are served from the current table until the new one is published
+	Block, //!< Same as Stale, but lookups of categories not found in the current table wait for the load to finish, except from log handlers called by a load
+};
+
+///	\brief Same as \ref load_pathfinder, but the file is parsed and resolved on a background thread.
+///	\note Asynchronous loads are published in the same order as any other load.
+///		\p p_logHandler is used from the background thread and must outlive the load.
+///		The load completes even if the returned future is dropped.
+///	\return Becomes true once the new table is published, or false if loading failed.
+pathfinder_API std::shared_future<bool> load_pathfinder_async(const std::filesystem::path& p_file, Log_proxy& p_logHandler, LoadFlag p_flags = LoadFlag{}, AsyncMode p_mode = AsyncMode::Stale);
 
-pathfinder_API bool load_pathfinder	(const std::filesystem::path& p_file, Log_proxy& p_logHandler);
 pathfinder_API void clear_pathfinder();
 
+///	\brief Sets the handler that receives the diagnostics of reloads triggered by \ref LoadFlag::Watch.
+///	\note \p p_logHandler must stay alive until it is replaced, or reset with nullptr, it is called from the watcher thread.
+///		Without a handler these diagnostics are dropped.
+pathfinder_API void set_watch_log_handler(Log_proxy* p_logHandler);
+
+///	\brief Resolves every category of the current table loaded with \ref LoadFlag::Lazy that was not used yet.
+///	\note Diagnostics of lazy values are kept by the table rather than sent to the handler given when loading,
+///		they are reported to \p p_logHandler by this call, including the ones of values resolved by earlier lookups.
+///	\return false if any of them could not be resolved, those resolve to an empty path.
+pathfinder_API bool resolve_all_pathfinder(Log_proxy& p_logHandler);
+
+///	\brief Statistics of a load, see \ref PathFinder::Load_stats.
+///	\note The per-phase times are only measured when loading with \ref LoadFlag::Profile.
+struct load_stats
+{
+	std::chrono::nanoseconds total;
+	std::chrono::nanoseconds read;      //!< reading mapped or cached images
+	std::chrono::nanoseconds parse;     //!< reading and parsing configuration files
+	std::chrono::nanoseconds resolve;   //!< resolving entries into paths
+	std::chrono::nanoseconds build;     //!< building the table
+	std::chrono::nanoseconds validate;  //!< validating categories
+	std::chrono::nanoseconds expand;    //!< expanding environment variables
+	std::chrono::nanoseconds convert;   //!< converting text into native paths
+	std::chrono::nanoseconds normalize; //!< normalizing paths
+	uint64_t files;
+	uint64_t cached;     //!< files loaded from the cache
+	uint64_t entries;
+	uint64_t duplicates;
+	uint64_t errors;
+	uint64_t bytes;      //!< memory used by the table
+};
+
+///	\brief Statistics of the last load or reload, successful or not.
+///	\note When watched files are loaded again the statistics add up over every file.
+pathfinder_API load_stats last_load_stats();
+
+struct missed_category
+{
+	std::u8string category;
+	uint64_t      count; //!< estimated from samples
+};
+
+struct lookup_stats
+{
+	uint64_t hits;
+	uint64_t misses;
+	std::vector<missed_category> top_missed; //!< most missed categories, most missed first
+};
+
+///	\brief Lookups counted by the path_find functions and \ref path_acquire since the last \ref reset_lookup_stats.
+///	\note Each thread counts in its own record, the totals are not a consistent snapshot while lookups are in progress.
+///		Misses are sampled, \p p_top limits the amount of missed categories returned.
+pathfinder_API lookup_stats get_lookup_stats(uintptr_t p_top = 10);
+
+pathfinder_API void reset_lookup_stats();
+
 } //namespace pathfinder
@@ -26,29 +26,990 @@
 //======== ======== ======== ======== ======== ======== ======== ========
 
 #include <pathfinder/pathfinder.hpp>
+#include <pathfinder/pathfinder_c.h>
+#include <pathfinder/pathfinder_category.hpp>
+#include <pathfinder/pathfinder_handle.hpp>
+#include <pathfinder/pathfinder_join.hpp>
 #include <pathfinder/pathfinder_service.hpp>
 #include <pathfinderLib/pathfinder.hpp>
+#include <pathfinderLib/pathfinder_flags.hpp>
+#include <pathfinderLib/pathfinder_publisher.hpp>
+#include <pathfinderLib/pathfinder_watcher.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
 
 namespace pathfinder
 {
 namespace
 {
-	static PathFinder g_instance;
+	static PathFinder_publisher g_instance;
+	static std::filesystem::path const g_emptyPath;
+
+	struct source_t
+	{
+		std::filesystem::path file;
+		LoadFlag              flags;
+		std::shared_ptr<Environment const> environment; //!< nullptr to use the process environment
+	};
+
+	static std::vector<source_t> g_sources; //!< Everything loaded since the last reload/clear, guarded by the writer mutex
+
+	///	\brief Drops every message before it is formatted
+	class Log_discard final: public Log_proxy
+	{
+	public:
+		Log_discard() { set_filter(logger::Level::Debug, 0); }
+		void push2log(core::os_string_view, uint32_t, uint32_t, logger::Level, std::u8string_view) final {}
+	};
+
+	static Log_proxy* g_watchLog = nullptr; //!< see set_watch_log_handler, guarded by the writer mutex
+	static File_watcher g_watcher;
+	static std::mutex g_watcherMutex; //!< Serializes starting and stopping the watcher, always taken before the writer mutex
+
+	static std::mutex g_statsMutex;
+	static load_stats g_loadStats; //!< of the last load, guarded by g_statsMutex
+
+	static void add_stats(load_stats& p_stats, PathFinder::Load_stats const& p_load)
+	{
+		p_stats.total      += p_load.total;
+		p_stats.read       += p_load.read;
+		p_stats.parse      += p_load.parse;
+		p_stats.resolve    += p_load.resolve;
+		p_stats.build      += p_load.build;
+		p_stats.validate   += p_load.validate;
+		p_stats.expand     += p_load.expand;
+		p_stats.convert    += p_load.convert;
+		p_stats.normalize  += p_load.normalize;
+		p_stats.files      += p_load.files;
+		p_stats.cached     += p_load.cached;
+		p_stats.entries    += p_load.entries;
+		p_stats.duplicates += p_load.duplicates;
+		p_stats.errors     += p_load.errors;
+		p_stats.bytes       = p_load.bytes;
+	}
+
+	static void set_stats(load_stats const& p_stats)
+	{
+		std::lock_guard const lock{g_statsMutex};
+		g_loadStats = p_stats;
+	}
+
+	static thread_local bool t_loading = false; //!< the thread holds the writer mutex, see wait_blocking_loads
+
+	///	\brief Holds the writer mutex of g_instance, the thread counts as loading for as long as it does.
+	///	\note Log handlers called while loading may look up paths, they must not wait for loads that need this mutex.
+	class writer_lock
+	{
+	public:
+		inline writer_lock()
+			: m_wasLoading{t_loading}
+			, m_lock      {g_instance.writer_mutex()}
+		{
+			t_loading = true;
+		}
+
+		inline ~writer_lock()
+		{
+			t_loading = m_wasLoading;
+		}
+
+		writer_lock(writer_lock const&) = delete;
+		writer_lock& operator = (writer_lock const&) = delete;
+
+	private:
+		bool const m_wasLoading;
+		std::lock_guard<std::mutex> const m_lock;
+	};
+
+	///	\brief Rebuilds the table from every source when a watched file changes.
+	///	\note Entries that did not change are shared with the current table, if any file fails to load the current table is kept.
+	static void reload_sources()
+	{
+		writer_lock const lock;
+
+		PathFinder const* const current = g_instance.current();
+		if(g_sources.empty())
+		{
+			return;
+		}
+
+		//the handlers given when loading are not kept, they need not outlive the call
+		Log_discard discard;
+		Log_proxy& log = g_watchLog ? *g_watchLog : discard;
+
+		load_stats stats{};
+		std::unique_ptr<PathFinder> next = std::make_unique<PathFinder>();
+		for(source_t const& source : g_sources)
+		{
+			bool const res = current ?
+				next->load(source.file, log, source.flags, *current, source.environment.get()) :
+				next->load(source.file, log, source.flags, source.environment.get());
+			add_stats(stats, next->load_stats());
+			if(!res)
+			{
+				set_stats(stats);
+				return;
+			}
+		}
+		set_stats(stats);
+		g_instance.publish(std::move(next));
+	}
+
+	///	\brief Starts the watcher if any of the sources asked to be watched.
+	///	\note Requires g_watcherMutex, g_watcher must be stopped.
+	static void start_watcher()
+	{
+		bool watch = false;
+		{
+			writer_lock const lock;
+			g_watcher.clear();
+			for(source_t const& source : g_sources)
+			{
+				if(has_flag(source.flags, LoadFlag::Watch))
+				{
+					g_watcher.add(source.file);
+					watch = true;
+				}
+			}
+		}
+
+		if(watch)
+		{
+			g_watcher.start(&reload_sources);
+		}
+	}
+
+	static std::atomic<uint32_t>   g_blockingLoads = 0; //!< loads in progress started with AsyncMode::Block
+	static std::mutex              g_asyncMutex;
+	static std::condition_variable g_asyncDone;
+
+	///	\brief Loads in progress, keeps them going if the caller drops its future.
+	///	\note Declared last so that it is destroyed first, waiting for loads that still use the state above.
+	static std::vector<std::shared_future<bool>> g_asyncLoads;
+
+	///	\brief Waits for every load started with AsyncMode::Block to finish.
+	///	\return false if there was nothing to wait for.
+	static bool wait_blocking_loads()
+	{
+		//a log handler looking up paths would otherwise wait for a load that waits for the writer mutex held by its own thread
+		if(t_loading || g_blockingLoads.load(std::memory_order_acquire) == 0)
+		{
+			return false;
+		}
+
+		std::unique_lock lock{g_asyncMutex};
+		g_asyncDone.wait(lock, []() { return g_blockingLoads.load(std::memory_order_acquire) == 0; });
+		return true;
+	}
+
+	///	\brief Lookup counters of a thread.
+	///	\note Only written by the thread that owns it, so that counting a lookup takes no atomic read-modify-write.
+	///		Records are never freed, once a thread exits its record and counts are taken over by the next new thread.
+	struct alignas(64) lookup_counter_t
+	{
+		std::atomic<uint64_t> hits   = 0;
+		std::atomic<uint64_t> misses = 0;
+		std::atomic<bool>     in_use = true;
+		lookup_counter_t*     next   = nullptr;
+	};
+
+	static std::atomic<lookup_counter_t*> g_counters = nullptr;
+
+	class thread_counter
+	{
+	public:
+		thread_counter()
+		{
+			for(lookup_counter_t* it = g_counters.load(std::memory_order_acquire); it; it = it->next)
+			{
+				bool expected = false;
+				if(!it->in_use.load(std::memory_order_relaxed) &&
+					it->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+				{
+					m_counter = it;
+					return;
+				}
+			}
+
+			m_counter = new lookup_counter_t;
+			m_counter->next = g_counters.load(std::memory_order_relaxed);
+			while(!g_counters.compare_exchange_weak(m_counter->next, m_counter, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		~thread_counter()
+		{
+			m_counter->in_use.store(false, std::memory_order_release);
+		}
+
+		inline lookup_counter_t& counter() { return *m_counter; }
+
+	private:
+		lookup_counter_t* m_counter;
+	};
+
+	static lookup_counter_t& local_counter()
+	{
+		thread_local thread_counter t_counter;
+		return t_counter.counter();
+	}
+
+	inline void increment(std::atomic<uint64_t>& p_counter, uint64_t const p_count = 1)
+	{
+		p_counter.store(p_counter.load(std::memory_order_relaxed) + p_count, std::memory_order_relaxed);
+	}
+
+	///	\brief Only one miss in this many is sampled to find the most missed categories
+	static constexpr uint64_t  miss_sample_rate = 16;
+	static constexpr uintptr_t missed_capacity  = 64;
+
+	struct missed_t
+	{
+		std::u8string category;
+		uint64_t      count;
+	};
+
+	static std::mutex            g_missedMutex;
+	static std::vector<missed_t> g_missed;           //!< most sampled misses, guarded by g_missedMutex
+	static uint64_t              g_hitsBaseline   = 0; //!< counts at the last reset, guarded by g_missedMutex
+	static uint64_t              g_missesBaseline = 0;
+
+	///	\brief Space-Saving: a category not tracked yet replaces the least missed one and inherits its count,
+	///		so that frequently missed categories always make it in, their counts being overestimated at worst.
+	static void sample_miss(std::u8string_view const p_category)
+	{
+		std::lock_guard const lock{g_missedMutex};
+		std::vector<missed_t>::iterator const it = std::find_if(g_missed.begin(), g_missed.end(),
+			[p_category](missed_t const& p_missed) { return p_missed.category == p_category; });
+		if(it != g_missed.end())
+		{
+			++it->count;
+			return;
+		}
+		if(g_missed.size() < missed_capacity)
+		{
+			g_missed.push_back(missed_t{.category = std::u8string{p_category}, .count = 1});
+			return;
+		}
+		missed_t& least = *std::min_element(g_missed.begin(), g_missed.end(),
+			[](missed_t const& p_1, missed_t const& p_2) { return p_1.count < p_2.count; });
+		least.category = p_category;
+		++least.count;
+	}
+
+	inline void count_hit()
+	{
+		increment(local_counter().hits);
+	}
+
+	static void count_miss(std::u8string_view const p_category)
+	{
+		lookup_counter_t& counter = local_counter();
+		uint64_t const misses = counter.misses.load(std::memory_order_relaxed);
+		counter.misses.store(misses + 1, std::memory_order_relaxed);
+		if(misses % miss_sample_rate == 0)
+		{
+			sample_miss(p_category);
+		}
+	}
+
+	///	\brief Category last found through a given string, in the snapshot of a given generation.
+	///	\note \p key and \p path belong to that snapshot, they are only used while it is the current one.
+	struct lookup_slot_t
+	{
+		char8_t const*               data;
+		uintptr_t                    size;
+		uint64_t                     generation; //!< 0 never matches, snapshots are numbered from 1
+		std::u8string_view           key;
+		std::filesystem::path const* path;
+	};
+
+	static constexpr uintptr_t lookup_cache_bits = 5;
+
+	///	\brief Direct-mapped cache of the last categories found by the calling thread, indexed by the address of the name.
+	///	\note Call sites passing the same literal over and over hit the same slot.
+	///		Constant initialized and trivially destructible, so that accessing it does not go through a thread local guard.
+	static thread_local lookup_slot_t t_lookupCache[uintptr_t{1} << lookup_cache_bits];
+
+	///	\brief Finds \p p_category in \p p_snapshot going through the cache of the calling thread.
+	///	\return nullptr if not found, misses are not cached.
+	static std::filesystem::path const* cached_find(PathFinder const& p_snapshot, std::u8string_view const p_category)
+	{
+		uint64_t const address = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(p_category.data()));
+		lookup_slot_t& slot = t_lookupCache[((address ^ p_category.size()) * 0x9E3779B97F4A7C15) >> (64 - lookup_cache_bits)];
+
+		uint64_t const generation = p_snapshot.generation();
+		//the key is still compared, the same buffer may have been reused for a different name
+		if(slot.data == p_category.data() && slot.size == p_category.size() && slot.generation == generation && slot.key == p_category)
+		{
+			return slot.path;
+		}
+
+		uint32_t const index = p_snapshot.find(p_category, PathTable::hash(p_category));
+		if(index == PathTable::npos)
+		{
+			return nullptr;
+		}
+
+		std::filesystem::path const& res = p_snapshot.path_at(index);
+		slot = lookup_slot_t{
+			.data       = p_category.data(),
+			.size       = p_category.size(),
+			.generation = generation,
+			.key        = p_snapshot.key_at(index),
+			.path       = &res};
+		return &res;
+	}
+
+	static_assert(category_hash(u8"pathfinder") == PathTable::hash(u8"pathfinder"), "category_hash must match the table hash");
+	static_assert(PathFinder_publisher::protected_snapshots == 4, "the lifetime of path_find references is documented in pathfinder.hpp");
+}
+
+pathfinder_API const std::filesystem::path& path_find(std::u8string_view const p_category)
+{
+	do
+	{
+		PathFinder const* const snapshot = g_instance.acquire();
+		if(snapshot)
+		{
+			std::filesystem::path const* const res = cached_find(*snapshot, p_category);
+			if(res)
+			{
+				count_hit();
+				return *res;
+			}
+		}
+	}
+	while(wait_blocking_loads());
+	count_miss(p_category);
+	return g_emptyPath;
+}
+
+namespace
+{
+	///	\brief Generation of a binding while a thread updates it, published tables never reach it
+	static constexpr uint64_t binding_busy = ~uint64_t{0};
+
+	///	\brief Index of \p p_category in \p p_snapshot, taken from \p p_binding if it was bound to that same table.
+	///	\note The generation and the index are a seqlock, a single thread claims the binding to update it,
+	///		the others look the category up on their own meanwhile.
+	static uint32_t bound_index(PathFinder const& p_snapshot, std::u8string_view const p_category, uint64_t const p_hash, category_binding& p_binding)
+	{
+		uint64_t const generation = p_snapshot.generation();
+		uint64_t bound = p_binding.generation.load(std::memory_order_acquire);
+		if(bound == generation)
+		{
+			uint32_t const index = p_binding.index.load(std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(p_binding.generation.load(std::memory_order_relaxed) == generation)
+			{
+				return index;
+			}
+			bound = binding_busy;
+		}
+
+		uint32_t const index = p_snapshot.find(p_category, p_hash);
+		if(bound != binding_busy && bound < generation &&
+			p_binding.generation.compare_exchange_strong(bound, binding_busy, std::memory_order_relaxed))
+		{
+			std::atomic_thread_fence(std::memory_order_release);
+			p_binding.index.store(index, std::memory_order_relaxed);
+			p_binding.generation.store(generation, std::memory_order_release);
+		}
+		return index;
+	}
+} //namespace
+
+pathfinder_API const std::filesystem::path& path_find(std::u8string_view const p_category, uint64_t const p_hash, category_binding& p_binding)
+{
+	do
+	{
+		PathFinder const* const snapshot = g_instance.acquire();
+		if(!snapshot)
+		{
+			continue;
+		}
+
+		uint32_t const index = bound_index(*snapshot, p_category, p_hash, p_binding);
+		if(index != PathTable::npos)
+		{
+			count_hit();
+			return snapshot->path_at(index);
+		}
+	}
+	while(wait_blocking_loads());
+	count_miss(p_category);
+	return g_emptyPath;
+}
+
+pathfinder_API std::u8string_view path_find_u8(std::u8string_view const p_category)
+{
+	uint64_t const hash = PathTable::hash(p_category);
+	do
+	{
+		PathFinder const* const snapshot = g_instance.acquire();
+		if(snapshot)
+		{
+			uint32_t const index = snapshot->find(p_category, hash);
+			if(index != PathTable::npos)
+			{
+				count_hit();
+				return snapshot->u8path_at(index);
+			}
+		}
+	}
+	while(wait_blocking_loads());
+	count_miss(p_category);
+	return std::u8string_view{u8""};
 }
 
-pathfinder_API const std::filesystem::path& path_find(std::u8string_view p_category)
+pathfinder_API path_view::value_type const* path_find_cstr(std::u8string_view const p_category)
 {
-	return g_instance.get_path(p_category);
+	path_view const res = path_find_view(p_category);
+	return res.empty() ? g_emptyPath.c_str() : res.data;
 }
 
-pathfinder_API bool load_pathfinder(const std::filesystem::path& p_file, Log_proxy& p_logHandler)
+pathfinder_API int path_find_dirfd(std::u8string_view const p_category)
+{
+	uint64_t const hash = PathTable::hash(p_category);
+	do
+	{
+		PathFinder const* const snapshot = g_instance.acquire();
+		if(snapshot)
+		{
+			uint32_t const index = snapshot->find(p_category, hash);
+			if(index != PathTable::npos)
+			{
+				count_hit();
+				return snapshot->directory_at(index);
+			}
+		}
+	}
+	while(wait_blocking_loads());
+	count_miss(p_category);
+	return -1;
+}
+
+namespace
+{
+	static constexpr native_char join_separator = std::filesystem::path::preferred_separator;
+	static constexpr uintptr_t   invalid_segment = ~uintptr_t{0};
+	static constexpr char32_t    invalid_code_point = ~char32_t{0};
+
+	///	\brief Decodes the code point at \p p_it and moves past it.
+	///	\return invalid_code_point if the sequence is not valid UTF-8
+	static char32_t decode_utf8(std::u8string_view::const_iterator& p_it, std::u8string_view::const_iterator const p_end)
+	{
+		char8_t const lead = *(p_it++);
+		if(lead < 0x80)
+		{
+			return lead;
+		}
+
+		uint8_t  extra;
+		char32_t code;
+		char32_t minimum;
+		if((lead & 0xE0) == 0xC0)
+		{
+			extra = 1; code = lead & 0x1F; minimum = 0x80;
+		}
+		else if((lead & 0xF0) == 0xE0)
+		{
+			extra = 2; code = lead & 0x0F; minimum = 0x800;
+		}
+		else if((lead & 0xF8) == 0xF0)
+		{
+			extra = 3; code = lead & 0x07; minimum = 0x10000;
+		}
+		else
+		{
+			return invalid_code_point;
+		}
+
+		for(; extra; --extra, ++p_it)
+		{
+			if(p_it == p_end || (*p_it & 0xC0) != 0x80)
+			{
+				return invalid_code_point;
+			}
+			code = (code << 6) | (*p_it & 0x3F);
+		}
+
+		if(code < minimum || code > 0x10FFFF || (code >= 0xD800 && code <= 0xDFFF))
+		{
+			return invalid_code_point;
+		}
+		return code;
+	}
+
+	///	\brief Size of \p p_segment in native characters, invalid_segment if it can not be converted
+	static uintptr_t native_size(path_segment const& p_segment)
+	{
+		if(!p_segment.is_u8())
+		{
+			return p_segment.native().size();
+		}
+
+		std::u8string_view const text = p_segment.u8();
+		if constexpr(sizeof(native_char) == sizeof(char8_t))
+		{
+			return text.size();
+		}
+		else
+		{
+			uintptr_t size = 0;
+			for(std::u8string_view::const_iterator it = text.begin(); it != text.end();)
+			{
+				char32_t const code = decode_utf8(it, text.end());
+				if(code == invalid_code_point)
+				{
+					return invalid_segment;
+				}
+				size += code > 0xFFFF ? 2 : 1;
+			}
+			return size;
+		}
+	}
+
+	///	\brief Writes \p p_segment in the native encoding, it must have been validated by native_size.
+	static native_char* write_segment(path_segment const& p_segment, native_char* p_out)
+	{
+		if(!p_segment.is_u8())
+		{
+			return std::copy(p_segment.native().begin(), p_segment.native().end(), p_out);
+		}
+
+		std::u8string_view const text = p_segment.u8();
+		if constexpr(sizeof(native_char) == sizeof(char8_t))
+		{
+			return std::transform(text.begin(), text.end(), p_out, [](char8_t const p_char) { return static_cast<native_char>(p_char); });
+		}
+		else
+		{
+			for(std::u8string_view::const_iterator it = text.begin(); it != text.end();)
+			{
+				char32_t const code = decode_utf8(it, text.end());
+				if(code > 0xFFFF)
+				{
+					*(p_out++) = static_cast<native_char>(0xD800 + ((code - 0x10000) >> 10));
+					*(p_out++) = static_cast<native_char>(0xDC00 + ((code - 0x10000) & 0x3FF));
+				}
+				else
+				{
+					*(p_out++) = static_cast<native_char>(code);
+				}
+			}
+			return p_out;
+		}
+	}
+
+	static bool ends_with_separator(path_segment const& p_segment)
+	{
+		//separators are ASCII, so the last code unit tells in either encoding
+		char32_t const last =
+			p_segment.is_u8() ?
+				(p_segment.u8().empty() ? 0 : p_segment.u8().back()) :
+				(p_segment.native().empty() ? 0 : static_cast<char32_t>(p_segment.native().back()));
+		return last == static_cast<char32_t>(join_separator) || last == U'/';
+	}
+} //namespace
+
+pathfinder_API join_result path_join(std::u8string_view const p_category, std::span<native_char> const p_out, std::span<path_segment const> const p_segments)
 {
-	return g_instance.load(p_file, p_logHandler);
+	auto const fail = [p_out](join_status const p_status, uintptr_t const p_size)
+		{
+			if(!p_out.empty())
+			{
+				p_out[0] = 0;
+			}
+			return join_result{.status = p_status, .size = p_size};
+		};
+
+	path_view const root = path_find_view(p_category);
+	if(root.empty())
+	{
+		return fail(join_status::NotFound, 0);
+	}
+
+	path_segment const root_segment{root.native()};
+	uintptr_t size = root.size;
+	bool separated = ends_with_separator(root_segment);
+	for(path_segment const& segment : p_segments)
+	{
+		uintptr_t const segment_size = native_size(segment);
+		if(segment_size == invalid_segment)
+		{
+			return fail(join_status::Invalid, 0);
+		}
+		if(segment_size != 0)
+		{
+			size += segment_size + (separated ? 0 : 1);
+			separated = ends_with_separator(segment);
+		}
+	}
+
+	if(size >= p_out.size())
+	{
+		return fail(join_status::Overflow, size);
+	}
+
+	native_char* it = std::copy_n(root.data, root.size, p_out.data());
+	separated = ends_with_separator(root_segment);
+	for(path_segment const& segment : p_segments)
+	{
+		if(segment.is_u8() ? !segment.u8().empty() : !segment.native().empty())
+		{
+			if(!separated)
+			{
+				*(it++) = join_separator;
+			}
+			it = write_segment(segment, it);
+			separated = ends_with_separator(segment);
+		}
+	}
+	*it = 0;
+	return join_result{.status = join_status::Ok, .size = size};
+}
+
+pathfinder_API path_handle path_acquire(std::u8string_view const p_category)
+{
+	path_handle res;
+	res.m_name = p_category;
+	uint64_t const hash = PathTable::hash(p_category);
+	do
+	{
+		//read before the snapshot, if anything is published in between the handle is seen as changed
+		uint64_t const generation = g_instance.generation();
+		PathFinder const* const snapshot = g_instance.acquire();
+		res.m_generation = snapshot ? snapshot->generation() : generation;
+		if(snapshot)
+		{
+			uint32_t const index = snapshot->find(p_category, hash);
+			if(index != PathTable::npos)
+			{
+				count_hit();
+				res.m_path = snapshot->shared_path_at(index);
+				return res;
+			}
+		}
+	}
+	while(wait_blocking_loads());
+	count_miss(p_category);
+	return res;
+}
+
+pathfinder_API uint64_t path_generation()
+{
+	return g_instance.generation();
+}
+
+pathfinder_API path_view path_find_view(std::u8string_view const p_category)
+{
+	uint64_t const hash = PathTable::hash(p_category);
+	do
+	{
+		PathFinder const* const snapshot = g_instance.acquire();
+		if(snapshot)
+		{
+			uint32_t const index = snapshot->find(p_category, hash);
+			if(index != PathTable::npos)
+			{
+				count_hit();
+				core::os_string_view const res = snapshot->path_view_at(index);
+				return path_view{.data = res.data(), .size = res.size()};
+			}
+		}
+	}
+	while(wait_blocking_loads());
+	count_miss(p_category);
+	return path_view{};
+}
+
+namespace
+{
+	static uintptr_t find_many(std::span<const std::u8string_view> const p_categories, std::span<const std::filesystem::path*> const p_paths, std::span<uint64_t> const p_missed)
+	{
+		PathFinder const* snapshot = g_instance.acquire();
+		if(snapshot)
+		{
+			uintptr_t const missed = snapshot->get_paths(p_categories, p_paths, p_missed);
+			if(missed == 0 || !wait_blocking_loads())
+			{
+				return missed;
+			}
+			snapshot = g_instance.acquire();
+		}
+		else if(wait_blocking_loads())
+		{
+			snapshot = g_instance.acquire();
+		}
+
+		if(snapshot)
+		{
+			return snapshot->get_paths(p_categories, p_paths, p_missed);
+		}
+
+		std::fill_n(p_paths.begin(), p_categories.size(), &g_emptyPath);
+		std::fill(p_missed.begin(), p_missed.end(), uint64_t{0});
+		if(!p_missed.empty())
+		{
+			for(uintptr_t i = 0, size = p_categories.size(); i < size; ++i)
+			{
+				p_missed[i / 64] |= uint64_t{1} << (i % 64);
+			}
+		}
+		return p_categories.size();
+	}
+} //namespace
+
+pathfinder_API uintptr_t path_find_many(std::span<const std::u8string_view> const p_categories, std::span<const std::filesystem::path*> const p_paths, std::span<uint64_t> const p_missed)
+{
+	uintptr_t const missed = find_many(p_categories, p_paths, p_missed);
+
+	lookup_counter_t& counter = local_counter();
+	increment(counter.hits, p_categories.size() - missed);
+	if(missed)
+	{
+		uint64_t const misses = counter.misses.load(std::memory_order_relaxed);
+		counter.misses.store(misses + missed, std::memory_order_relaxed);
+
+		//the misses of a batch are sampled as if counted one by one
+		for(uintptr_t i = 0, sample = misses % miss_sample_rate, size = p_categories.size(); i < size; ++i)
+		{
+			if(p_paths[i]->empty() && sample++ % miss_sample_rate == 0)
+			{
+				sample_miss(p_categories[i]);
+			}
+		}
+	}
+	return missed;
+}
+
+pathfinder_API void path_quiescent()
+{
+	PathFinder_publisher::quiescent();
+}
+
+namespace
+{
+	static bool load_source(source_t&& p_source, Log_proxy& p_logHandler)
+	{
+		std::lock_guard const watcherLock{g_watcherMutex};
+		bool const watch = has_flag(p_source.flags, LoadFlag::Watch);
+		{
+			writer_lock const lock;
+
+			PathFinder const* const current = g_instance.current();
+			std::unique_ptr<PathFinder> next = std::make_unique<PathFinder>();
+
+			//the new snapshot shares the entries of the current one rather than copying it
+			bool const res = current ?
+				next->load_layer(*current, p_source.file, p_logHandler, p_source.flags, p_source.environment.get()) :
+				next->load(p_source.file, p_logHandler, p_source.flags, p_source.environment.get());
+			load_stats stats{};
+			add_stats(stats, next->load_stats());
+			set_stats(stats);
+			if(!res)
+			{
+				return false;
+			}
+			g_instance.publish(std::move(next));
+			g_sources.push_back(std::move(p_source));
+
+			if(g_watcher.running())
+			{
+				if(watch)
+				{
+					g_watcher.add(g_sources.back().file);
+				}
+				return true;
+			}
+		}
+
+		if(watch)
+		{
+			start_watcher();
+		}
+		return true;
+	}
+
+	static bool reload_source(source_t&& p_source, Log_proxy& p_logHandler)
+	{
+		std::lock_guard const watcherLock{g_watcherMutex};
+		//the watcher callback takes the writer mutex, it must be stopped before taking it
+		g_watcher.stop();
+
+		bool res = false;
+		{
+			writer_lock const lock;
+
+			std::unique_ptr<PathFinder> next = std::make_unique<PathFinder>();
+			res = next->load(p_source.file, p_logHandler, p_source.flags, p_source.environment.get());
+			load_stats stats{};
+			add_stats(stats, next->load_stats());
+			set_stats(stats);
+			if(res)
+			{
+				g_instance.publish(std::move(next));
+				g_sources.clear();
+				g_sources.push_back(std::move(p_source));
+			}
+		}
+
+		start_watcher();
+		return res;
+	}
+} //namespace
+
+pathfinder_API bool load_pathfinder(const std::filesystem::path& p_file, Log_proxy& p_logHandler, LoadFlag const p_flags)
+{
+	return load_source(source_t{.file = p_file, .flags = p_flags, .environment = nullptr}, p_logHandler);
+}
+
+pathfinder_API bool load_pathfinder(const std::filesystem::path& p_file, Log_proxy& p_logHandler, LoadFlag const p_flags, Environment const& p_environment)
+{
+	return load_source(source_t{.file = p_file, .flags = p_flags, .environment = std::make_shared<Environment const>(p_environment)}, p_logHandler);
+}
+
+pathfinder_API bool reload_pathfinder(const std::filesystem::path& p_file, Log_proxy& p_logHandler, LoadFlag const p_flags)
+{
+	return reload_source(source_t{.file = p_file, .flags = p_flags, .environment = nullptr}, p_logHandler);
+}
+
+pathfinder_API bool reload_pathfinder(const std::filesystem::path& p_file, Log_proxy& p_logHandler, LoadFlag const p_flags, Environment const& p_environment)
+{
+	return reload_source(source_t{.file = p_file, .flags = p_flags, .environment = std::make_shared<Environment const>(p_environment)}, p_logHandler);
+}
+
+pathfinder_API std::shared_future<bool> load_pathfinder_async(const std::filesystem::path& p_file, Log_proxy& p_logHandler, LoadFlag const p_flags, AsyncMode const p_mode)
+{
+	bool const blocking = p_mode == AsyncMode::Block;
+	if(blocking)
+	{
+		g_blockingLoads.fetch_add(1, std::memory_order_acq_rel);
+	}
+
+	std::shared_future<bool> res = std::async(std::launch::async,
+		[file = p_file, &p_logHandler, p_flags, blocking]()
+		{
+			struct done_t
+			{
+				bool const blocking;
+				~done_t()
+				{
+					if(blocking)
+					{
+						{
+							std::lock_guard const lock{g_asyncMutex};
+							g_blockingLoads.fetch_sub(1, std::memory_order_acq_rel);
+						}
+						g_asyncDone.notify_all();
+					}
+				}
+			} const done{blocking};
+
+			return load_pathfinder(file, p_logHandler, p_flags);
+		}).share();
+
+	std::lock_guard const lock{g_asyncMutex};
+	std::erase_if(g_asyncLoads, [](std::shared_future<bool> const& p_load) { return p_load.wait_for(std::chrono::seconds{0}) == std::future_status::ready; });
+	g_asyncLoads.push_back(res);
+	return res;
+}
+
+pathfinder_API void set_watch_log_handler(Log_proxy* const p_logHandler)
+{
+	writer_lock const lock;
+	g_watchLog = p_logHandler;
+}
+
+pathfinder_API bool resolve_all_pathfinder(Log_proxy& p_logHandler)
+{
+	PathFinder const* const snapshot = g_instance.acquire();
+	return snapshot == nullptr || snapshot->resolve_all(p_logHandler);
+}
+
+pathfinder_API load_stats last_load_stats()
+{
+	std::lock_guard const lock{g_statsMutex};
+	return g_loadStats;
+}
+
+pathfinder_API lookup_stats get_lookup_stats(uintptr_t const p_top)
+{
+	lookup_stats res{.hits = 0, .misses = 0, .top_missed = {}};
+	for(lookup_counter_t const* it = g_counters.load(std::memory_order_acquire); it; it = it->next)
+	{
+		res.hits   += it->hits.load(std::memory_order_relaxed);
+		res.misses += it->misses.load(std::memory_order_relaxed);
+	}
+
+	std::lock_guard const lock{g_missedMutex};
+	res.hits   -= g_hitsBaseline;
+	res.misses -= g_missesBaseline;
+
+	std::vector<missed_t> sorted = g_missed;
+	std::sort(sorted.begin(), sorted.end(), [](missed_t const& p_1, missed_t const& p_2) { return p_1.count > p_2.count; });
+	sorted.resize(std::min<uintptr_t>(sorted.size(), p_top));
+	res.top_missed.reserve(sorted.size());
+	for(missed_t& missed : sorted)
+	{
+		res.top_missed.push_back(missed_category{.category = std::move(missed.category), .count = missed.count * miss_sample_rate});
+	}
+	return res;
+}
+
+pathfinder_API void reset_lookup_stats()
+{
+	std::lock_guard const lock{g_missedMutex};
+	g_hitsBaseline   = 0;
+	g_missesBaseline = 0;
+	for(lookup_counter_t const* it = g_counters.load(std::memory_order_acquire); it; it = it->next)
+	{
+		g_hitsBaseline   += it->hits.load(std::memory_order_relaxed);
+		g_missesBaseline += it->misses.load(std::memory_order_relaxed);
+	}
+	g_missed.clear();
 }
 
 pathfinder_API void clear_pathfinder()
 {
-	g_instance.clear();
+	std::lock_guard const watcherLock{g_watcherMutex};
+	g_watcher.stop();
+
+	writer_lock const lock;
+	g_sources.clear();
+	g_watcher.clear();
+	g_instance.publish(nullptr);
 }
 
 } //namespace pathfinder
+
+static_assert(std::is_same_v<pathfinder_os_char, std::filesystem::path::value_type>, "pathfinder_os_char must match the native path encoding");
+
+pathfinder_API pathfinder_u8_string pathfinder_find_u8(char const* const p_category, uintptr_t const p_size)
+{
+	std::u8string_view const res = pathfinder::path_find_u8(std::u8string_view{reinterpret_cast<char8_t const*>(p_category), p_size});
+	return pathfinder_u8_string{.data = reinterpret_cast<char const*>(res.data()), .size = res.size()};
+}
+
+pathfinder_API pathfinder_os_string pathfinder_find_native(char const* const p_category, uintptr_t const p_size)
+{
+	pathfinder::path_view const res = pathfinder::path_find_view(std::u8string_view{reinterpret_cast<char8_t const*>(p_category), p_size});
+	if(res.empty())
+	{
+		return pathfinder_os_string{.data = pathfinder::g_emptyPath.c_str(), .size = 0};
+	}
+	return pathfinder_os_string{.data = res.data, .size = res.size};
+}
+
+pathfinder_API void pathfinder_quiescent(void)
+{
+	pathfinder::path_quiescent();
+}
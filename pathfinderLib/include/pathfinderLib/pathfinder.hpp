@@ -27,12 +27,19 @@
 
 #pragma once
 
-#include <map>
+#include <chrono>
+#include <cstdint>
 #include <filesystem>
+#include <memory>
+#include <span>
 #include <string>
 #include <string_view>
 
+#include "pathfinder_directories.hpp"
+#include "pathfinder_environment.hpp"
+#include "pathfinder_flags.hpp"
 #include "pathfinder_prelog_proxy.hpp"
+#include "pathfinder_table.hpp"
 
 namespace scef
 {
@@ -42,6 +49,7 @@ namespace scef
 /// \n
 namespace pathfinder
 {
+	class Mapped_table;
 
 	/*template<typename T1, typename T2>
 	inline constexpr bool less(T1 const& p_1, T2 const& p_2) { return p_1 < p_2; }*/
@@ -49,17 +57,141 @@ namespace pathfinder
 	class PathFinder
 	{
 	public:
+		///	\brief Measurements of the last load.
+		///	\note Phases of resolving the values are only timed with \ref LoadFlag::Profile,
+		///		they are summed across the threads that resolved them and can therefore exceed the wall time.
+		struct Load_stats
+		{
+			std::chrono::nanoseconds total    {}; //!< Wall time of the whole load
+			std::chrono::nanoseconds read     {}; //!< Checking, reading or mapping the caches
+			std::chrono::nanoseconds parse    {}; //!< Reading and parsing the files, SCEF does both in one go
+			std::chrono::nanoseconds resolve  {}; //!< Wall time spent validating and resolving keys
+			std::chrono::nanoseconds build    {}; //!< Merging the entries, building the index and writing the cache
+			std::chrono::nanoseconds validate {}; //!< Validating keys
+			std::chrono::nanoseconds expand   {}; //!< Assembling values and expanding environment variables, excluding conversion
+			std::chrono::nanoseconds convert  {}; //!< Converting values to the native encoding
+			std::chrono::nanoseconds normalize{}; //!< Normalizing paths
+			uint64_t files      = 0; //!< Files loaded, including failed ones
+			uint64_t cached     = 0; //!< Files loaded from a cache
+			uint64_t entries    = 0; //!< Entries added
+			uint64_t duplicates = 0; //!< Keys ignored because they were already defined
+			uint64_t errors     = 0; //!< Keys or values rejected, and files that failed to load
+			uint64_t bytes      = 0; //!< Approximate memory held by the table once loaded
+		};
 
-		bool load(std::filesystem::path const& p_fileName, Log_proxy& p_logProxy);
-		inline void clear() { m_pathTable.clear(); }
+
+		///	\brief Loads the categories in \p p_fileName, categories already loaded take precedence.
+		///	\note With \ref LoadFlag::UseCache the cache holds every entry of \p p_fileName, including the ones
+		///		shadowed by categories loaded before, diagnostics emitted while parsing are not repeated when loading from the cache.
+		///		\ref LoadFlag::MapCache only maps the cache if nothing was loaded before, and is otherwise treated as UseCache.
+		///		With \ref LoadFlag::Lazy diagnostics of the values are kept by this table when they are first used,
+		///		and only reported by \ref resolve_all, \p p_logProxy is not referred to after the load returns.
+		///		A lazy value that fails to resolve still defines its key, with an empty path, and so hides the same key
+		///		in files of lower precedence, which an eager load would have used instead.
+		///	\param[in] p_environment - Variables used to expand the values, if nullptr a snapshot of the process environment is taken.
+		bool load(std::filesystem::path const& p_fileName, Log_proxy& p_logProxy, LoadFlag p_flags = LoadFlag::None, Environment const* p_environment = nullptr);
+
+		///	\brief Same as \ref load, but entries of \p p_previous whose resolved path did not change are reused as they are.
+		///	\note Values that did not change and do not reference environment variables are not resolved again,
+		///		this holds as well when \p p_previous is served from a mapped cache, its entries are then copied out of the mapping.
+		bool load(std::filesystem::path const& p_fileName, Log_proxy& p_logProxy, LoadFlag p_flags, PathFinder const& p_previous, Environment const* p_environment = nullptr);
+
+		///	\brief Same as \ref load into a copy of \p p_base, without copying it.
+		///	\note Entries of \p p_base are shared with this table and take precedence over the ones in \p p_fileName.
+		///		\ref LoadFlag::MapCache is treated as UseCache unless \p p_base is empty.
+		///	\warning Replaces the current content.
+		bool load_layer(PathFinder const& p_base, std::filesystem::path const& p_fileName, Log_proxy& p_logProxy, LoadFlag p_flags = LoadFlag::None, Environment const* p_environment = nullptr);
+
+		///	\brief Loads a stack of layered files, later files take precedence over earlier ones.
+		///	\note Caches are read in parallel, then files are merged from the last to the first, each one parsed right before it is merged
+		///		so that a single parsed file is held at a time. Keys overridden by a later file are reported as already defined, like consecutive calls to \ref load would.
+		///		Diagnostics are reported in that same order. \ref LoadFlag::MapCache is treated as UseCache,
+		///		and the cache of each file holds its own entries so that it can be reused in any stack.
+		///	\return false if any of the files failed to load, the files that loaded are kept.
+		bool load(std::span<std::filesystem::path const> p_files, Log_proxy& p_logProxy, LoadFlag p_flags = LoadFlag::None, Environment const* p_environment = nullptr);
+
+		///	\brief Loads every "*.scef" file in \p p_directory as layers, see \ref load.
+		///	\note Files are layered in name order, the last one has the highest precedence.
+		bool load_directory(std::filesystem::path const& p_directory, Log_proxy& p_logProxy, LoadFlag p_flags = LoadFlag::None, Environment const* p_environment = nullptr);
+
+		void clear();
 		std::filesystem::path const& get_path(std::u8string_view p_name) const;
 
+		///	\brief Same as \ref get_path but does not require a std::filesystem::path to exist.
+		///	\return Native representation of the path, null terminated. Empty if the category was not found.
+		core::os_string_view get_path_view(std::u8string_view p_name) const;
+
+		///	\brief Batch version of \ref get_path.
+		///	\param[in] p_names - Categories to look up
+		///	\param[out] p_paths - Path of each category, an empty path if not found. Must be at least as large as p_names.
+		///	\param[out] p_missed - Bitmap where bit i is set if p_names[i] was not found.
+		///		Must have at least (p_names.size() + 63) / 64 words, or be empty if not needed.
+		///	\return Number of categories not found.
+		uintptr_t get_paths(std::span<std::u8string_view const> p_names, std::span<std::filesystem::path const*> p_paths, std::span<uint64_t> p_missed) const;
+
+		///	\brief Index of category \p p_name, or PathTable::npos if not found.
+		///	\note Indexes are only meaningful for the snapshot that produced them.
+		uint32_t find(std::u8string_view p_name, uint64_t p_hash) const;
+		std::filesystem::path const& path_at(uint32_t p_index) const;
+		core::os_string_view path_view_at(uint32_t p_index) const;
+		std::u8string_view key_at(uint32_t p_index) const;
+
+		///	\brief UTF-8 form of \ref path_at, null terminated. Does not allocate outside of Windows,
+		///		on Windows it is computed once per entry when it is loaded, or on first request for a mapped cache.
+		std::u8string_view u8path_at(uint32_t p_index) const;
+
+		///	\brief Descriptor of the directory of entry \p p_index, opened with O_PATH on first request. Thread safe.
+		///	\return -1 if it could not be opened or if not supported, see \ref Directory_handles.
+		///	\note Owned by this snapshot, it is closed when the snapshot is destroyed or loaded into.
+		int directory_at(uint32_t p_index) const;
+
+		///	\brief Same as \ref path_at, but the path is kept alive by the returned pointer rather than by this snapshot.
+		std::shared_ptr<std::filesystem::path const> shared_path_at(uint32_t p_index) const;
+
+		///	\brief Resolves every entry loaded with \ref LoadFlag::Lazy that was not used yet.
+		///	\note Reports to \p p_logProxy the diagnostics of every lazy value resolved since the last call, including by lookups.
+		///		Thread safe.
+		///	\return false if any of them could not be resolved, those resolve to an empty path.
+		bool resolve_all(Log_proxy& p_logProxy) const;
+
+		///	\brief Number assigned by \ref PathFinder_publisher when this snapshot was published, 0 if never published.
+		inline uint64_t generation() const { return m_generation; }
+
+		///	\brief Measurements of the last call to \ref load or \ref load_directory.
+		inline Load_stats const& load_stats() const { return m_stats; }
+
 	private:
-		void validate_and_push(scef::keyedValue const& p_key, std::filesystem::path const& p_directory, Log_proxy& p_logProxy, std::filesystem::path const& p_fileName);
+		struct source_file;
+		struct Lazy_log;
+
+		///	\param[in] p_base - Entries loaded before, that take precedence over the ones in \p p_files, may be nullptr
+		bool load_files(std::span<std::filesystem::path const> p_files, Log_proxy& p_logProxy, LoadFlag p_flags, PathFinder const* p_previous, PathFinder const* p_base, Environment const* p_environment);
+
+		///	\brief Reads the cache or parses the file, safe to call from several threads.
+		///	\param[in] p_parse - Whether to parse the file if it could not be served from its cache, otherwise left to \ref parse_file
+		static bool prepare_file(std::filesystem::path const& p_fileName, Log_proxy& p_logProxy, LoadFlag p_flags, Environment const& p_environment, bool p_parse, source_file& p_source);
 
-		using pathTable_t = std::map<std::u8string, std::filesystem::path const, std::less<>>;
-		pathTable_t m_pathTable;
+		///	\brief Parses a file prepared without parsing it, safe to call from several threads.
+		static bool parse_file(Log_proxy& p_logProxy, Environment const& p_environment, source_file& p_source);
+
+		///	\brief Merges a prepared file into the table.
+		bool merge_file(source_file& p_source, Log_proxy& p_logProxy, LoadFlag p_flags, PathFinder const* p_previous, PathFinder const* p_base, std::shared_ptr<Environment const> const& p_environment);
+
+		///	\brief Whether \p p_key is already defined by this table or by \p p_base
+		bool defined(std::u8string_view p_key, PathFinder const* p_base) const;
+
+		///	\brief Moves the content of a mapped cache into m_table so that more entries can be merged into it
+		void materialize();
+
+		PathTable m_table;
+		std::shared_ptr<Mapped_table const> m_mapped;
+		std::shared_ptr<Lazy_log> m_lazyLog; //!< diagnostics of lazy values, shared with the tables that share their entries
 		std::filesystem::path const emptyPath;
+		uint64_t m_generation = 0;
+		Load_stats m_stats;
+		Directory_handles m_directories;
+
+		friend class PathFinder_publisher;
 	};
 
 } //namespace pathfinder
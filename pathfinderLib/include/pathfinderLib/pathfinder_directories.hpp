@@ -0,0 +1,68 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+
+/// \n
+namespace pathfinder
+{
+
+	///	\brief Directory descriptors of the entries of a table, opened on first request.
+	///	\note Descriptors are opened with O_PATH, they can only be used as the base of *at calls (openat, statx, etc.).
+	///		They are tied to the table they were opened for, copies start empty. Only supported on Linux.
+	class Directory_handles
+	{
+	public:
+		Directory_handles() = default;
+		inline Directory_handles(Directory_handles const&) {}
+		inline Directory_handles& operator = (Directory_handles const&) { reset(); return *this; }
+		~Directory_handles();
+
+		///	\brief Descriptor of \p p_path, which is entry \p p_index of a table of \p p_count entries. Thread safe.
+		///	\return -1 if the directory could not be opened, opening is attempted again on the next request.
+		int open(uint32_t p_index, uint32_t p_count, std::filesystem::path::value_type const* p_path) const;
+
+		///	\brief Closes every descriptor.
+		///	\warning Not thread safe, only call it while the table is not shared.
+		void reset();
+
+	private:
+		struct handles_t
+		{
+			uint32_t count;
+			std::unique_ptr<std::atomic<int>[]> fds; //!< descriptor + 1, 0 if not opened
+		};
+
+		mutable std::atomic<handles_t*> m_handles = nullptr;
+	};
+
+} //namespace pathfinder
@@ -0,0 +1,73 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include <map>
+#include <optional>
+
+#include <CoreLib/string/core_os_string.hpp>
+
+/// \n
+namespace pathfinder
+{
+
+	///	\brief Set of environment variables used to expand the values of a path file.
+	///	\note A load only ever sees the environment it was given, changes to the process environment made during the load are not observed.
+	///		On Windows names are compared case-insensitively, like the system does.
+	class Environment
+	{
+	public:
+		struct name_less
+		{
+			using is_transparent = void;
+			bool operator () (core::os_string_view p_1, core::os_string_view p_2) const;
+		};
+
+		using variables_t = std::map<core::os_string, core::os_string, name_less>;
+
+	public:
+		Environment() = default;
+		inline explicit Environment(variables_t p_variables): m_variables{std::move(p_variables)} {}
+
+		///	\brief Takes a snapshot of the whole process environment.
+		static Environment capture();
+
+		///	\return Value of \p p_name, or std::nullopt if it is not defined.
+		///	\note The view is valid for as long as this object is not modified.
+		std::optional<core::os_string_view> get(core::os_string_view p_name) const;
+
+		void set(core::os_string p_name, core::os_string p_value);
+		void erase(core::os_string_view p_name);
+
+		inline variables_t const& variables() const { return m_variables; }
+
+	private:
+		variables_t m_variables;
+	};
+
+} //namespace pathfinder
@@ -27,6 +27,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <limits>
 #include <string_view>
 
 #include <CoreLib/string/core_os_string.hpp>
@@ -36,10 +39,64 @@
 namespace pathfinder
 {
 
+class Log_deferred;
+
 class Log_proxy
 {
 public:
+	Log_proxy() = default;
+
+	///	\brief Copies the filter, along with the count of messages emitted so far.
+	inline Log_proxy(Log_proxy const& p_other)
+		: m_minLevel{p_other.m_minLevel}
+		, m_maxCount{p_other.m_maxCount}
+		, m_count   {p_other.m_count.load(std::memory_order_relaxed)}
+	{}
+
+	inline Log_proxy& operator = (Log_proxy const& p_other)
+	{
+		m_minLevel = p_other.m_minLevel;
+		m_maxCount = p_other.m_maxCount;
+		m_count.store(p_other.m_count.load(std::memory_order_relaxed), std::memory_order_relaxed);
+		return *this;
+	}
+
 	virtual void push2log(core::os_string_view p_file, uint32_t p_line, uint32_t p_column, logger::Level p_level, std::u8string_view p_message) = 0;
+
+	///	\brief Whether a message of level \p p_level is to be emitted, checked before the message is formatted.
+	///	\note Every accepted message counts towards the maximum count. Thread safe.
+	inline bool accept(logger::Level const p_level)
+	{
+		return p_level >= m_minLevel && m_count.fetch_add(1, std::memory_order_relaxed) < m_maxCount;
+	}
+
+	///	\brief Messages below \p p_minLevel are dropped, as well as any message past the first \p p_maxCount.
+	///	\note Also resets the count of messages emitted so far.
+	inline void set_filter(logger::Level const p_minLevel, uint64_t const p_maxCount = std::numeric_limits<uint64_t>::max())
+	{
+		m_minLevel = p_minLevel;
+		m_maxCount = p_maxCount;
+		m_count.store(0, std::memory_order_relaxed);
+	}
+
+	///	\brief Applies the filter of \p p_target, with the messages it can still emit as the maximum count.
+	///	\note For buffers that are replayed into \p p_target later on.
+	inline void inherit_filter(Log_proxy const& p_target)
+	{
+		uint64_t const count = p_target.m_count.load(std::memory_order_relaxed);
+		set_filter(p_target.m_minLevel, count < p_target.m_maxCount ? p_target.m_maxCount - count : 0);
+	}
+
+	inline logger::Level min_level() const { return m_minLevel; }
+	inline uint64_t max_count() const { return m_maxCount; }
+
+	///	\brief Set if the proxy records the arguments of messages, to format them only once they are replayed.
+	virtual Log_deferred* deferred() { return nullptr; }
+
+private:
+	logger::Level         m_minLevel = logger::Level::Debug;
+	uint64_t              m_maxCount = std::numeric_limits<uint64_t>::max();
+	std::atomic<uint64_t> m_count    = 0;
 };
 
 } //namespace pathfinder
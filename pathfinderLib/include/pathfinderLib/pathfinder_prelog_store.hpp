@@ -29,14 +29,34 @@
 
 #include "pathfinder_prelog_proxy.hpp"
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <queue>
+#include <string>
+#include <string_view>
 
 namespace pathfinder
 {
 
+///	\brief Collects messages from any number of threads, to be drained by a single consumer.
+///	\note Records live in an arena of chunks that is only released as a whole by \ref clear or on destruction,
+///		file names are interned so that each distinct name is stored once.
+///		push2log is lock-free and may be called concurrently with \ref drain.
 class Log_store: public Log_proxy
 {
 public:
+	///	\brief View of a stored message, valid until \ref clear is called or the store is destroyed.
+	struct record_t
+	{
+		core::os_string_view file;
+		uint32_t             line;
+		uint32_t             column;
+		logger::Level        level;
+		std::u8string_view   message;
+	};
+
+	///	\brief Owning copy of a stored message, see \ref take_data.
 	struct data_t
 	{
 		core::os_string	file;
@@ -56,10 +76,71 @@ public:
 
 public:
 	Log_store();
+	~Log_store();
 	void push2log(core::os_string_view p_file, uint32_t p_line, uint32_t p_column, logger::Level p_level, std::u8string_view p_message) final;
 
-public:
-	std::queue<data_t> m_data;
+	///	\brief Hands every message stored since the last drain to \p p_consumer, in the order they were stored.
+	///	\note Only one thread may drain at a time. Messages being stored concurrently may be left for the next drain.
+	///	\return Number of messages drained.
+	template<typename Consumer>
+	uintptr_t drain(Consumer&& p_consumer)
+	{
+		uintptr_t count = 0;
+		for(node_t* next; (next = m_head->next.load(std::memory_order_acquire)) != nullptr; m_head = next)
+		{
+			p_consumer(record_t{.file = next->file->name(), .line = next->line, .column = next->column, .level = next->level, .message = next->message()});
+			++count;
+		}
+		return count;
+	}
+
+	///	\brief Forwards the messages stored since the last drain to \p p_target, subject to its filter.
+	void replay(Log_proxy& p_target);
+
+	///	\brief Moves the messages stored since the last drain into a queue of owning copies.
+	///	\note Replaces the public m_data queue that used to hold every message, same rules as \ref drain.
+	[[deprecated("Use drain or replay, which do not copy the messages")]]
+	std::queue<data_t> take_data();
+
+	///	\brief Whether all stored messages were drained.
+	inline bool empty() const { return m_head->next.load(std::memory_order_acquire) == nullptr; }
+
+	///	\brief Releases every message at once.
+	///	\warning No other thread may be using the store, views previously drained become invalid.
+	void clear();
+
+private:
+	struct file_t
+	{
+		file_t const* next;
+		uintptr_t     size;
+
+		inline core::os_string_view name() const { return {reinterpret_cast<core::os_char const*>(this + 1), size}; }
+	};
+
+	struct node_t
+	{
+		std::atomic<node_t*>       next;
+		file_t const*              file;
+		uint32_t                   line;
+		uint32_t                   column;
+		logger::Level              level;
+		uintptr_t                  size;
+
+		inline std::u8string_view message() const { return {reinterpret_cast<char8_t const*>(this + 1), size}; }
+	};
+
+	struct chunk_t;
+
+	///	\brief Reserves \p p_size bytes in the arena, suitably aligned for any of the records
+	void* allocate(uintptr_t p_size);
+	file_t const* intern(core::os_string_view p_file);
+
+	std::atomic<chunk_t*>      m_chunk = nullptr; //!< chunk being allocated from, links to the previous ones
+	std::atomic<file_t const*> m_files = nullptr; //!< interned file names
+	std::atomic<node_t*>       m_tail;            //!< last message stored
+	node_t*                    m_head;            //!< last message drained
+	node_t                     m_stub;
 };
 
 } //namespace pathfinder
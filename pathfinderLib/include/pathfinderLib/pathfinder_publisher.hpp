@@ -0,0 +1,97 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "pathfinder.hpp"
+
+/// \n
+namespace pathfinder
+{
+
+	///	\brief Publishes immutable \ref PathFinder snapshots to concurrent readers.
+	///	\note Readers never block nor take locks.
+	///		Each thread protects the last \ref protected_snapshots distinct snapshots it obtained through \ref acquire, with hazard pointers,
+	///		until it acquires that many newer ones, calls \ref quiescent or exits.
+	///		A replaced snapshot is freed as soon as no thread protects it anymore, by the writer or by the reader that lets go of it last.
+	///		Memory held by replaced snapshots is therefore bounded by the number of threads, regardless of how often they are replaced.
+	///	\warning The protected snapshots of a thread are shared by every publisher it acquires from.
+	class PathFinder_publisher
+	{
+	public:
+		///	\brief Number of snapshots each thread keeps alive, so that what it obtained survives that many reloads.
+		static constexpr uint32_t protected_snapshots = 4;
+
+	public:
+		PathFinder_publisher();
+		~PathFinder_publisher();
+
+		PathFinder_publisher(PathFinder_publisher const&) = delete;
+		PathFinder_publisher& operator = (PathFinder_publisher const&) = delete;
+
+		///	\brief Retrieves the current snapshot, may be nullptr if nothing was published.
+		///	\note If it is not already protected by the calling thread, the oldest snapshot it protects no longer is.
+		PathFinder const* acquire();
+
+		///	\brief Writer side access to the current snapshot, does not protect it.
+		///	\warning Only valid while holding \ref writer_mutex.
+		inline PathFinder const* current() const { return m_current.load(std::memory_order_acquire); }
+
+		///	\brief Declares that the calling thread no longer holds anything obtained through \ref acquire.
+		static void quiescent();
+
+		///	\brief Replaces the current snapshot, the previous one is retired and freed once no reader protects it.
+		///	\param[in] p_next - New snapshot, nullptr unpublishes the current one.
+		void publish(std::unique_ptr<PathFinder> p_next);
+
+		///	\brief Frees every retired snapshot that is no longer protected.
+		void reclaim();
+
+		///	\brief Serializes writers, use it to read-modify-publish the current snapshot.
+		inline std::mutex& writer_mutex() { return m_writerMutex; }
+
+		inline uint64_t generation() const { return m_generation.load(std::memory_order_acquire); }
+
+	private:
+		///	\pre m_retiredMutex is held
+		void reclaim_locked();
+
+		std::atomic<PathFinder const*> m_current = nullptr;
+		std::atomic<uint64_t>          m_generation = 0;
+		std::mutex                     m_writerMutex;
+		std::mutex                     m_retiredMutex;
+		std::vector<std::unique_ptr<PathFinder const>> m_retired;
+		std::atomic<uintptr_t>         m_retiredCount = 0; //!< size of m_retired, lets readers skip reclaiming when there is nothing to free
+	};
+
+} //namespace pathfinder
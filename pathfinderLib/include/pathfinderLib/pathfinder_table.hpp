@@ -0,0 +1,194 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <CoreLib/string/core_os_string.hpp>
+
+/// \n
+namespace pathfinder
+{
+
+	///	\brief Read-only flat index over the resolved path categories.
+	///	\note Built once by \ref freeze after a load has finished, lookups only touch the slot array and the matched entry.
+	///		Entries are immutable and shared, tables built from one another keep the same entry objects.
+	class PathTable
+	{
+	public:
+		struct entry_t;
+
+		///	\brief Resolves the paths of entries loaded with \ref LoadFlag::Lazy
+		class Lazy_source
+		{
+		public:
+			///	\brief Resolves the value of \p p_entry into \p p_path, problems are reported by the implementation.
+			///	\return false if the value could not be resolved
+			virtual bool resolve(entry_t const& p_entry, std::filesystem::path& p_path) const = 0;
+
+		protected:
+			~Lazy_source() = default;
+		};
+
+		///	\brief Unresolved value of a lazy entry
+		struct lazy_t
+		{
+			std::shared_ptr<Lazy_source const> source;
+			std::u32string                     value;
+			uint32_t                           line;
+			uint32_t                           column;
+			std::once_flag                     once;
+			std::filesystem::path              path;   //!< Set once resolved, empty if the value could not be resolved
+		};
+
+		///	\brief Made by an \ref Entry_arena, which stores the key and the path along with the entry.
+		struct entry_t
+		{
+			std::u8string_view      key;
+			core::os_string_view    native;                  //!< Resolved path, null terminated. Empty if the entry is lazy, see \ref resolved_native
+			uint64_t                hash          = 0;
+			uint64_t                value_hash    = 0;       //!< Hash of the unresolved value, 0 if unknown
+			bool                    env_dependent = false;   //!< Whether the value references environment variables
+			std::unique_ptr<lazy_t> lazy          = nullptr; //!< Set if the path is resolved on first use
+
+			entry_t() = default;
+			entry_t(entry_t const&) = delete;
+			entry_t& operator = (entry_t const&) = delete;
+			~entry_t();
+
+			///	\brief Path of the entry, lazy entries are resolved exactly once by the first caller. Thread safe.
+			///	\note Created on first request, lookups that only need \ref resolved_native never create it.
+			///	\return An empty path if the entry could not be resolved.
+			std::filesystem::path const& resolved_path() const;
+
+			///	\brief Native form of \ref resolved_path, null terminated. Thread safe.
+			core::os_string_view resolved_native() const;
+
+			///	\brief UTF-8 form of \ref resolved_path, null terminated. Thread safe.
+			///	\note The native encoding already is UTF-8 outside of Windows, on Windows it is converted on first request.
+			std::u8string_view resolved_u8path() const;
+
+		private:
+			mutable std::atomic<std::filesystem::path const*> m_path = nullptr;
+#ifdef _WIN32
+			mutable std::atomic<std::u8string const*> m_u8path = nullptr;
+#endif
+		};
+
+		using entry_ptr = std::shared_ptr<entry_t const>;
+		using entries_t = std::vector<entry_ptr>;
+
+		///	\brief Makes entries without allocating for each of them.
+		///	\note Entries are stored along with their key and path in blocks, a block is released with the last entry made in it.
+		///		Not thread safe, each thread making entries uses its own arena.
+		class Entry_arena
+		{
+		public:
+			Entry_arena();
+
+			entry_ptr make_entry(std::u8string_view p_key, core::os_string_view p_path, uint64_t p_valueHash = 0, bool p_envDependent = false);
+
+			///	\brief Makes an entry whose path is resolved by the source of \p p_lazy on first use
+			entry_ptr make_lazy_entry(std::u8string_view p_key, std::unique_ptr<lazy_t>&& p_lazy, uint64_t p_valueHash, bool p_envDependent);
+
+		private:
+			std::shared_ptr<entry_t> make(std::u8string_view p_key, core::os_string_view p_path);
+
+			template<typename T>
+			T* store(std::basic_string_view<T> p_text);
+
+			std::shared_ptr<std::pmr::monotonic_buffer_resource> m_resource;
+		};
+
+		static constexpr uint32_t npos = 0xFFFFFFFF;
+
+	public:
+		///	\brief 64bit FNV-1a over the key bytes
+		static constexpr uint64_t hash(std::u8string_view const p_key)
+		{
+			uint64_t res = 0xCBF29CE484222325;
+			for(char8_t const tchar : p_key)
+			{
+				res = (res ^ static_cast<uint8_t>(tchar)) * 0x00000100000001B3;
+			}
+			return res;
+		}
+
+		///	\brief Merges \p p_staging with the current content and rebuilds the index.
+		///	\note Keys already present in the table take precedence over the ones in \p p_staging.
+		///	\param[in] p_staging - Entries sorted by key, with no repeated keys.
+		void freeze(entries_t&& p_staging);
+
+		void clear();
+
+		///	\brief Replaces the entries in \p p_entries that are identical to one of ours by our own object.
+		///	\note Lazy entries are never considered identical, comparing them would require resolving them.
+		void share_unchanged(entries_t& p_entries) const;
+
+		uint32_t find(std::u8string_view p_key) const;
+		uint32_t find(std::u8string_view p_key, uint64_t p_hash) const;
+
+		///	\brief Looks up several keys at once, overlapping the memory accesses of independent probes.
+		///	\param[in] p_keys - Keys to look up
+		///	\param[out] p_out - Index of each key, or npos if not found. Must be at least as large as p_keys.
+		void find(std::span<std::u8string_view const> p_keys, std::span<uint32_t> p_out) const;
+
+		inline bool contains(std::u8string_view const p_key) const { return find(p_key) != npos; }
+		inline entry_t const& operator[](uint32_t const p_index) const { return *m_entries[p_index]; }
+		inline entry_ptr const& entry(uint32_t const p_index) const { return m_entries[p_index]; }
+		inline uint32_t size() const { return static_cast<uint32_t>(m_entries.size()); }
+		inline bool empty() const { return m_entries.empty(); }
+
+		///	\brief Approximate number of bytes held by the entries and the index.
+		///	\note Entries shared with other tables are counted in full.
+		uintptr_t memory_usage() const;
+
+	private:
+		struct slot_t
+		{
+			uint32_t tag;
+			uint32_t index;
+		};
+
+		void build_slots();
+
+		entries_t           m_entries;
+		std::vector<slot_t> m_slots;
+		uint64_t            m_mask = 0;
+	};
+
+} //namespace pathfinder
@@ -0,0 +1,109 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// \n
+namespace pathfinder
+{
+
+	///	\brief Watches a set of files and notifies when any of them changes.
+	///	\note On Linux it is driven by inotify, everywhere else (or if inotify is unavailable) it polls the files' size and modification time.
+	///		Bursts of changes are coalesced into a single notification.
+	class File_watcher
+	{
+	public:
+		using callback_t = std::function<void()>;
+
+	public:
+		File_watcher();
+		~File_watcher();
+
+		File_watcher(File_watcher const&) = delete;
+		File_watcher& operator = (File_watcher const&) = delete;
+
+		///	\brief Starts watching, \p p_callback is invoked from the watcher thread.
+		///	\note Stops any previous watch.
+		void start(callback_t p_callback, std::chrono::milliseconds p_pollInterval = std::chrono::milliseconds{1000});
+
+		///	\brief Stops watching and waits for the watcher thread to finish.
+		///	\warning Must not be called from the callback.
+		void stop();
+
+		///	\brief Adds a file to the watch list, can be called at any time.
+		void add(std::filesystem::path const& p_file);
+
+		///	\brief Removes every file from the watch list.
+		void clear();
+
+		inline bool running() const { return m_thread.joinable(); }
+
+	private:
+		struct file_state_t
+		{
+			std::filesystem::path           file;
+			std::filesystem::file_time_type mtime;
+			uintmax_t                       size;
+#ifdef __linux__
+			int                             watch = -1; //!< inotify descriptor of the directory of the file
+#endif
+		};
+
+		void run_polling();
+#ifdef __linux__
+		void run_inotify();
+		bool add_inotify_watch(file_state_t& p_state);
+#endif
+
+		bool wait_stop(std::chrono::milliseconds p_time);
+		bool poll_changed();
+
+		std::thread                m_thread;
+		callback_t                 m_callback;
+		std::chrono::milliseconds  m_pollInterval{1000};
+		std::atomic<bool>          m_stop = false;
+		std::mutex                 m_mutex;
+		std::condition_variable    m_stopCondition;
+		std::vector<file_state_t>  m_files;
+
+#ifdef __linux__
+		int m_inotifyFd = -1;
+		int m_wakeFd    = -1;
+		std::vector<int> m_watches;
+#endif
+	};
+
+} //namespace pathfinder
@@ -28,6 +28,11 @@
 #pragma once
 
 
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
 #include <CoreLib/toPrint/toPrint_sink.hpp>
 #include <CoreLib/toPrint/toPrint.hpp>
 
@@ -61,8 +66,102 @@ private:
 	logger::Level const  m_level;
 };
 
+///	\brief Records the arguments of messages, they are only formatted if and when replayed.
+///	\warning Arguments are copied as they are, the file and anything a view argument refers to must outlive the replay.
+class Log_deferred: public Log_proxy
+{
+public:
+	void push2log(core::os_string_view const p_file, uint32_t const p_line, uint32_t const p_column, logger::Level const p_level, std::u8string_view const p_message) final
+	{
+		record(p_file, p_line, p_column, p_level, std::u8string{p_message});
+	}
+
+	Log_deferred* deferred() final { return this; }
+
+	template<typename... Args>
+	void record(core::os_string_view const p_file, uint32_t const p_line, uint32_t const p_column, logger::Level const p_level, Args const&... p_args)
+	{
+		m_records.push_back(record_t{
+			.file    = p_file,
+			.line    = p_line,
+			.column  = p_column,
+			.level   = p_level,
+			.message = std::make_unique<message_t<std::decay_t<Args const&>...>>(p_args...)});
+	}
+
+	///	\brief Formats the messages in [p_begin, p_end) into \p p_target, subject to its filter.
+	void replay(Log_proxy& p_target, uintptr_t const p_begin, uintptr_t const p_end) const
+	{
+		for(uintptr_t i = p_begin; i < p_end; ++i)
+		{
+			record_t const& record = m_records[i];
+			if(p_target.accept(record.level))
+			{
+				record.message->print(Log_Assist(p_target, record.file, record.line, record.column, record.level));
+			}
+		}
+	}
+
+	inline uintptr_t size() const { return m_records.size(); }
+
+private:
+	class message_base
+	{
+	public:
+		virtual ~message_base() = default;
+		virtual void print(Log_Assist const& p_sink) const = 0;
+	};
+
+	template<typename... Args>
+	class message_t final: public message_base
+	{
+	public:
+		inline message_t(Args const&... p_args): m_args{p_args...} {}
+
+		void print(Log_Assist const& p_sink) const final
+		{
+			std::apply(
+				[&p_sink](Args const&... p_args)
+				{
+					core::print<char8_t>(p_sink, p_args...);
+				}, m_args);
+		}
+
+	private:
+		std::tuple<Args...> m_args;
+	};
+
+	struct record_t
+	{
+		core::os_string_view          file;
+		uint32_t                      line;
+		uint32_t                      column;
+		logger::Level                 level;
+		std::unique_ptr<message_base> message;
+	};
+
+	std::vector<record_t> m_records;
+};
+
 } //namespace pathfinder
 
+///	\brief Emits a message through \p Proxy, the arguments are only formatted if the proxy accepts the level,
+///		and are recorded instead if the proxy defers formatting.
 #define PRELOG_CUSTOM(Proxy, File, Line, Column, Level, ...) \
-	core::print<char8_t>(Log_Assist(Proxy, File, Line, Column, Level) __VA_OPT__(,) __VA_ARGS__)
+	do \
+	{ \
+		::pathfinder::Log_proxy& prelog_proxy_ = (Proxy); \
+		if(prelog_proxy_.accept(Level)) \
+		{ \
+			if(::pathfinder::Log_deferred* const prelog_deferred_ = prelog_proxy_.deferred()) \
+			{ \
+				prelog_deferred_->record(File, Line, Column, Level __VA_OPT__(,) __VA_ARGS__); \
+			} \
+			else \
+			{ \
+				core::print<char8_t>(::pathfinder::Log_Assist(prelog_proxy_, File, Line, Column, Level) __VA_OPT__(,) __VA_ARGS__); \
+			} \
+		} \
+	} \
+	while(false)
 
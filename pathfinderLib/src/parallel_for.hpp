@@ -0,0 +1,76 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace pathfinder
+{
+	///	\brief Calls \p p_function(i) for every i in [0, p_count), spread across as many threads as the hardware has.
+	///	\note The calling thread takes part in the work, returns once every call has completed.
+	template<typename Function>
+	void parallel_for(uintptr_t const p_count, Function&& p_function)
+	{
+		uintptr_t const workers = std::min<uintptr_t>(p_count, std::max(std::thread::hardware_concurrency(), 1u));
+		if(workers <= 1)
+		{
+			for(uintptr_t i = 0; i < p_count; ++i)
+			{
+				p_function(i);
+			}
+			return;
+		}
+
+		std::atomic<uintptr_t> next = 0;
+		auto const run = [&]()
+			{
+				for(uintptr_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < p_count;)
+				{
+					p_function(i);
+				}
+			};
+
+		std::vector<std::thread> threads;
+		threads.reserve(workers - 1);
+		for(uintptr_t i = 1; i < workers; ++i)
+		{
+			threads.emplace_back(run);
+		}
+		run();
+
+		for(std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+} //namespace pathfinder
@@ -0,0 +1,143 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include "path_normalize.hpp"
+
+#include <cstring>
+
+namespace pathfinder
+{
+namespace
+{
+#ifdef _WIN32
+	static constexpr core::os_char separator = L'\\';
+	static constexpr uintptr_t root_size = 3; //X:\ .
+
+	static inline bool is_separator(core::os_char const p_char)
+	{
+		return p_char == L'\\' || p_char == L'/';
+	}
+
+	static inline bool is_drive_root(core::os_string_view const p_path)
+	{
+		return p_path.size() >= 3 && p_path[1] == L':' && is_separator(p_path[2]) &&
+			((p_path[0] >= L'A' && p_path[0] <= L'Z') || (p_path[0] >= L'a' && p_path[0] <= L'z'));
+	}
+#else
+	static constexpr core::os_char separator = '/';
+	static constexpr uintptr_t root_size = 1;
+
+	static inline bool is_separator(core::os_char const p_char)
+	{
+		return p_char == '/';
+	}
+#endif
+} //namespace
+
+PathForm classify_path(core::os_string_view const p_path)
+{
+#ifdef _WIN32
+	if(is_drive_root(p_path))
+	{
+		return PathForm::Absolute;
+	}
+	if((!p_path.empty() && is_separator(p_path[0])) || (p_path.size() >= 2 && p_path[1] == L':'))
+	{
+		return PathForm::Other;
+	}
+	return PathForm::Relative;
+#else
+	return !p_path.empty() && p_path[0] == '/' ? PathForm::Absolute : PathForm::Relative;
+#endif
+}
+
+bool normalize_absolute(core::os_string& p_path)
+{
+	if(classify_path(p_path) != PathForm::Absolute)
+	{
+		return false;
+	}
+
+	core::os_char* const data = p_path.data();
+	uintptr_t const size = p_path.size();
+	data[root_size - 1] = separator;
+
+	//elements are compacted towards the front, every element written except the last one is followed by a separator.
+	//The path is absolute so ".." never has to be kept, it either removes the previous element or is dropped at the root
+	uintptr_t out = root_size;
+	uintptr_t pos = root_size;
+	while(pos < size)
+	{
+		if(is_separator(data[pos]))
+		{
+			++pos;
+			continue;
+		}
+
+		uintptr_t const start = pos;
+		while(pos < size && !is_separator(data[pos]))
+		{
+			++pos;
+		}
+		uintptr_t const length = pos - start;
+
+		if(length == 1 && data[start] == '.')
+		{
+			continue;
+		}
+
+		if(length == 2 && data[start] == '.' && data[start + 1] == '.')
+		{
+			if(out > root_size)
+			{
+				//out is always past a separator here, walk back to the start of the previous element
+				--out;
+				while(out > root_size && !is_separator(data[out - 1]))
+				{
+					--out;
+				}
+			}
+			continue;
+		}
+
+		if(out != start)
+		{
+			memmove(data + out, data + start, length * sizeof(core::os_char));
+		}
+		out += length;
+
+		if(pos < size)
+		{
+			data[out++] = separator;
+		}
+	}
+
+	p_path.resize(out);
+	return true;
+}
+
+} //namespace pathfinder
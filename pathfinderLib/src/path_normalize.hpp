@@ -0,0 +1,47 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include <CoreLib/string/core_os_string.hpp>
+
+namespace pathfinder
+{
+	enum class PathForm
+	{
+		Relative, //!< Relative to the current directory of its drive
+		Absolute, //!< Starts with a root that \ref normalize_absolute understands
+		Other,    //!< Anything else (UNC, device or drive relative paths on Windows), left to std::filesystem
+	};
+
+	PathForm classify_path(core::os_string_view p_path);
+
+	///	\brief Same as std::filesystem::path::lexically_normal, but rewrites \p p_path in place without allocating.
+	///	\return false if \p p_path is not \ref PathForm::Absolute, \p p_path is then left unchanged.
+	bool normalize_absolute(core::os_string& p_path);
+
+} //namespace pathfinder
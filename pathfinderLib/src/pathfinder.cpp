@@ -26,9 +26,16 @@
 //======== ======== ======== ======== ======== ======== ======== ========
 
 #include <pathfinderLib/pathfinder.hpp>
+#include <pathfinderLib/pathfinder_prelog_store.hpp>
 
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <mutex>
 #include <optional>
 #include <queue>
+#include <thread>
+#include <vector>
 
 #include <CoreLib/core_type.hpp>
 #include <CoreLib/core_os.hpp>
@@ -40,6 +47,10 @@
 #include <SCEF/SCEF.hpp>
 
 #include "log_assist.hpp"
+#include "parallel_for.hpp"
+#include "path_normalize.hpp"
+#include "pathfinder_cache.hpp"
+#include "utf_convert.hpp"
 
 
 #ifdef _WIN32
@@ -246,393 +257,1211 @@ namespace
 	}
 
 
-	static bool validateKey(std::u32string_view p_key)
+	///	\brief Identifies an unresolved value together with the directory it is relative to
+	static uint64_t hash_value(std::u32string_view const p_value, core::os_string_view const p_directory)
 	{
-		if(p_key.empty()) return false;
-		for(char32_t tchar : p_key)
+		uint64_t res = 0xCBF29CE484222325;
+		for(core::os_char const tchar : p_directory)
 		{
-			if(tchar < ' ' || tchar > 0xFF)
-			{
-				return false;
-			}
+			res = (res ^ static_cast<uint64_t>(tchar)) * 0x00000100000001B3;
+		}
+		res = (res ^ 0xFFFFFFFF) * 0x00000100000001B3;
+		for(char32_t const tchar : p_value)
+		{
+			res = (res ^ static_cast<uint64_t>(tchar)) * 0x00000100000001B3;
 		}
+		return res | 1; //0 is reserved for unknown
+	}
 
-		return true;
+
+	static core::os_string convert_to_os(std::u32string_view p_str)
+	{
+		core::os_string tstr;
+		if(!append_os(p_str, tstr))
+		{
+			return {};
+		}
+		return tstr;
 	}
 
+} //namespace
 
-#ifdef _WIN32
-	static uintptr_t convert_to_os_estimate(std::u32string_view p_input)
+
+namespace
+{
+	using clock_t = std::chrono::steady_clock;
+
+	///	\brief Adds the time elapsed until it goes out of scope to \p p_target, does nothing if \p p_target is nullptr.
+	class Phase_timer
 	{
-		uintptr_t count = 0;
+	public:
+		inline explicit Phase_timer(std::chrono::nanoseconds* const p_target)
+			: m_target{p_target}
+			, m_start{p_target ? clock_t::now() : clock_t::time_point{}}
+		{}
 
-		for(char32_t const tchar : p_input)
+		inline ~Phase_timer()
 		{
-			if(tchar < 0x10000)
+			if(m_target)
 			{
-				++count;
+				*m_target += std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - m_start);
 			}
-			else if(tchar < 0x110000)
-			{
-				count += 2;
-			}
-			else
+		}
+
+		Phase_timer(Phase_timer const&) = delete;
+		Phase_timer& operator = (Phase_timer const&) = delete;
+
+	private:
+		std::chrono::nanoseconds* const m_target;
+		clock_t::time_point const       m_start;
+	};
+
+	inline std::chrono::nanoseconds elapsed_since(clock_t::time_point const p_start)
+	{
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - p_start);
+	}
+
+	///	\brief Entries of a previous load that can be reused, held either by a table or by a mapped cache
+	struct previous_entries
+	{
+		PathTable const*   table = nullptr;
+		Cache_image const* image = nullptr;
+
+		inline explicit operator bool() const { return table || image; }
+
+		inline uint32_t find(std::u8string_view const p_key) const
+		{
+			uint64_t const t_hash = PathTable::hash(p_key);
+			return table ? table->find(p_key, t_hash) : image->find(p_key, t_hash);
+		}
+
+		inline uint64_t value_hash(uint32_t const p_index) const { return table ? (*table)[p_index].value_hash : image->value_hash(p_index); }
+		inline bool env_dependent(uint32_t const p_index) const { return table ? (*table)[p_index].env_dependent : image->env_dependent(p_index); }
+		inline bool lazy(uint32_t const p_index) const { return table && (*table)[p_index].lazy; }
+
+		inline core::os_string_view path(uint32_t const p_index) const
+		{
+			return table ? (*table)[p_index].native : image->path(p_index);
+		}
+
+		///	\brief Entry to reuse, a table shares its own while an entry is copied out of an image into \p p_arena
+		PathTable::entry_ptr entry(uint32_t const p_index, PathTable::Entry_arena& p_arena) const
+		{
+			if(table)
 			{
-				return 0;
+				return table->entry(p_index);
 			}
+			return p_arena.make_entry(image->key(p_index), image->path(p_index), image->value_hash(p_index), image->env_dependent(p_index));
 		}
-		return count;
-	}
+	};
+
+	///	\brief Environment variables referenced by a file, decoded and looked up once per load before its keys are split across workers
+	struct env_table
+	{
+		struct variable_t
+		{
+			core::os_string name;                       //!< empty if the name can not be represented natively
+			std::optional<core::os_string_view> value;  //!< points into the environment
+		};
 
-	static void convert_to_os_unsafe(std::u32string_view p_input, wchar_t* p_output)
+		std::map<std::u32string, variable_t, std::less<>> variables;
+	};
+
+	///	\brief Calls \p p_callback with the name of every environment variable referenced by \p p_value, delimited as read by resolve_path
+	template<typename Callback>
+	static void for_each_env_name(std::u32string_view p_value, Callback&& p_callback)
 	{
-		for(char32_t const tchar : p_input)
+		uintptr_t pos = p_value.find(char32_t{0});
+		while(pos != std::u32string_view::npos)
 		{
-			if(tchar > 0xFFFF)
+			p_value = p_value.substr(pos + 1);
+			pos = p_value.find(char32_t{0});
+			if(pos == std::u32string_view::npos)
 			{
-				*(p_output++) = 0xD800 | static_cast<wchar_t>((tchar - 0x010000) >> 10);
-				*(p_output++) = 0xDC00 | static_cast<wchar_t>(tchar & 0x03FF);
+				return;
 			}
-			else
+
+			std::u32string_view const name = p_value.substr(0, pos);
+			pos = p_value.find(char32_t{0}, pos + 1);
+			if(!name.empty())
 			{
-				*(p_output++) = static_cast<wchar_t>(tchar);
+				p_callback(name);
 			}
 		}
 	}
-#else
-	static uintptr_t convert_to_os_estimate(std::u32string_view p_input)
+
+	///	\brief Looks up every environment variable referenced by the keys of \p p_document
+	static std::shared_ptr<env_table const> intern_environment(scef::document& p_document, Environment const& p_environment)
 	{
-		uintptr_t count = 0;
-		for(char32_t const tchar : p_input)
-		{
-			if(tchar < 0x00000080) //Level 0
+		std::shared_ptr<env_table> table = std::make_shared<env_table>();
+		auto const intern = [&table, &p_environment](std::u32string_view const p_name)
 			{
-				++count;
-			}
-			else if(tchar < 0x00000800) //Level 1
+				if(table->variables.find(p_name) != table->variables.end())
+				{
+					return;
+				}
+				env_table::variable_t res{.name = convert_to_os(p_name), .value = std::nullopt};
+				if(!res.name.empty())
+				{
+					res.value = p_environment.get(res.name);
+				}
+				table->variables.emplace(p_name, std::move(res));
+			};
+
+		for(scef::itemProxy<scef::item> const& l1_item: p_document.root())
+		{
+			if(l1_item->type() != scef::ItemType::group || static_cast<scef::group*>(l1_item.get())->name() != U"pathfinder")
 			{
-				count += 2;
+				continue;
 			}
-			else if(tchar < 0x00010000) //Level 2
+			for(scef::itemProxy<scef::item> const& l2_item : *static_cast<scef::group*>(l1_item.get()))
 			{
-				count += 3;
+				if(l2_item->type() == scef::ItemType::key_value)
+				{
+					for_each_env_name(static_cast<scef::keyedValue const*>(l2_item.get())->value(), intern);
+				}
 			}
-			else if(tchar < 0x00110000) //Level 3
+		}
+		return table;
+	}
+
+	///	\brief Read-only state shared by every key of a file
+	struct load_state
+	{
+		Environment const&           environment;
+		env_table const&             variables;       //!< every variable referenced by the file, shared by the workers
+		std::filesystem::path const& fileName;
+		std::filesystem::path const& directory;
+		core::os_string_view         directoryPrefix;    //!< directory of the file followed by a separator
+		previous_entries             previous = {};      //!< entries that can be reused, if any
+		std::shared_ptr<PathTable::Lazy_source const> lazy = nullptr; //!< set if values are to be resolved on first use
+		bool                         profile  = false;   //!< whether to time each phase, see LoadFlag::Profile
+	};
+
+	///	\brief Time spent in each phase of resolving values, see PathFinder::Load_stats
+	struct phase_times
+	{
+		std::chrono::nanoseconds validate {};
+		std::chrono::nanoseconds assemble {}; //!< includes convert
+		std::chrono::nanoseconds convert  {};
+		std::chrono::nanoseconds normalize{};
+	};
+
+	///	\brief Scratch space of a worker resolving keys
+	struct resolve_scratch
+	{
+		PathTable::Entry_arena arena;   //!< entries made by this worker
+		std::u8string   keyBuffer;      //!< reused to narrow every key, only copied out of if its value can not be resolved
+		core::os_string pathBuffer;     //!< reused to assemble every path, which is only stored once by the arena
+		std::filesystem::path fallback; //!< reused for values that are not normalized in place
+		phase_times     times;          //!< only measured when profiling
+		Log_deferred log;           //!< diagnostics of every key resolved by this worker, only formatted for the keys that are kept
+	};
+
+	///	\brief Outcome of resolving a single key
+	struct resolved_key
+	{
+		std::u8string        key;      //!< only set if the key is valid but its value could not be resolved, see name()
+		PathTable::entry_ptr entry;    //!< null if the value could not be resolved
+		uint32_t             worker;   //!< worker that resolved the key
+		uint32_t             logBegin; //!< diagnostics in the worker's log
+		uint32_t             logEnd;
+		bool                 validKey  = false;
+		bool                 duplicate = false; //!< an earlier key of the same file with the same name was resolved
+
+		inline std::u8string_view name() const { return entry ? std::u8string_view{entry->key} : std::u8string_view{key}; }
+	};
+
+	///	\brief Unresolved value with the position it was read from, for diagnostics
+	struct value_ref
+	{
+		std::u8string_view  key;
+		std::u32string_view value;
+		uint32_t            line;
+		uint32_t            column;
+	};
+
+	enum class resolve_result: uint8_t
+	{
+		Failed,     //!< diagnostics were logged
+		Resolved,   //!< the path was stored in the output
+		Unchanged,  //!< the value resolves to the same path as the previous entry
+	};
+
+	///	\brief Expands, converts and normalizes a value.
+	///	\param[in] p_previous - Path the value resolved to before, if any
+	///	\param[out] p_path - Points into \p p_scratch, valid until it resolves the next value
+	static resolve_result resolve_path(value_ref const& p_value, load_state const& p_state, resolve_scratch& p_scratch, Log_proxy& p_logProxy,
+		std::optional<core::os_string_view> const p_previous, core::os_string_view& p_path)
+	{
+		std::u32string_view path_sv = p_value.value;
+		std::u8string_view const key = p_value.key;
+		phase_times* const times = p_state.profile ? &p_scratch.times : nullptr;
+
+		//the value is assembled right after the directory, which is dropped again if the value turns out to be absolute
+		core::os_string& partialPath = p_scratch.pathBuffer;
+		partialPath.assign(p_state.directoryPrefix);
+		uintptr_t const value_start = partialPath.size();
+
+		auto const convert = [&partialPath, times](std::u32string_view const p_part)
 			{
-				count += 4;
-			}
-			else
+				Phase_timer const timer{times ? &times->convert : nullptr};
+				return append_os(p_part, partialPath);
+			};
+
+		{
+			Phase_timer const timer{times ? &times->assemble : nullptr};
+			uintptr_t pos = 0;;
+			pos = path_sv.find(char32_t{0});
+			while(pos != core::os_string_view::npos)
 			{
-				if(tchar & 0x80000000)
+				if(pos != 0)
+				{
+					std::u32string_view aux = path_sv.substr(0, pos);
+
+					if(!convert(aux))
+					{
+						PRELOG_CUSTOM(p_logProxy, p_state.fileName.native(), p_value.line, p_value.column, logger::Level::Error,
+							"Invalid path element \""sv, aux,  "\" in key \""sv,  key, '\"');
+						return resolve_result::Failed;
+					}
+				}
+
+				path_sv = path_sv.substr(pos + 1);
+
+				pos = path_sv.find(char32_t{0});
+
+				if(pos == core::os_string_view::npos)
 				{
-					count += 4;
+					PRELOG_CUSTOM(p_logProxy, p_state.fileName.native(), p_value.line, p_value.column, logger::Level::Error,
+						"Bad environment delimiters in \""sv, key, '\"');
+					return resolve_result::Failed;
 				}
-				else
+
+				std::u32string_view env_val = path_sv.substr(0, pos);
+
+				++pos;
+				pos = path_sv.find(char32_t{0}, pos);
+				
+				if(env_val.empty())
+				{
+					continue;
+				}
+
+				//every name was interned by parse_file
+				env_table::variable_t const& env = p_state.variables.variables.find(env_val)->second;
+
+				if(env.name.empty())
+				{
+					PRELOG_CUSTOM(p_logProxy, p_state.fileName.native(), p_value.line, p_value.column, logger::Level::Error,
+						"Invalid environment variable \""sv, env_val, "\" in key \""sv, key, '\"');
+					return resolve_result::Failed;
+				}
+
+				if(!env.value.has_value())
 				{
-					uint8_t leading = static_cast<uint8_t>(tchar >> 24);
-					if(leading == 0 || leading > 3) return 0;
-					count += leading;
+					PRELOG_CUSTOM(p_logProxy, p_state.fileName.native(), p_value.line, p_value.column, logger::Level::Warning,
+						"Environment variable \""sv, env_val, "\" not found"sv);
+					continue;
+				}
+
+				partialPath += env.value.value();
+			}
+
+			//get remaining
+			if(!path_sv.empty())
+			{
+				if(!convert(path_sv))
+				{
+					PRELOG_CUSTOM(p_logProxy, p_state.fileName.native(), p_value.line, p_value.column, logger::Level::Error,
+						"Invalid path element \""sv, path_sv, "\" in key \""sv, key, '\"');
+					return resolve_result::Failed;
 				}
 			}
 		}
-		return count;
-	}
 
-	static void convert_to_os_unsafe(std::u32string_view p_input, char* p_output)
-	{
+		Phase_timer const timer{times ? &times->normalize : nullptr};
+		core::os_string_view const value{partialPath.data() + value_start, partialPath.size() - value_start};
+		PathForm const form = classify_path(value);
+		if(form == PathForm::Absolute)
+		{
+			partialPath.erase(0, value_start);
+		}
 
-		for(char32_t const tchar : p_input)
+		if(form != PathForm::Other && normalize_absolute(partialPath))
+		{
+			p_path = partialPath;
+		}
+		else
 		{
-			if(tchar < 0x00000080) //Level 0
+			std::filesystem::path& fallback = p_scratch.fallback;
+			fallback = std::filesystem::path{value};
+			if(!fallback.is_absolute())
 			{
-				*(p_output++) = static_cast<char>(tchar);
+				fallback = p_state.directory / fallback;
 			}
-			else if(tchar < 0x00000800) //Level 1
+			fallback = fallback.lexically_normal();
+			p_path = fallback.native();
+		}
+		return p_previous == p_path ? resolve_result::Unchanged : resolve_result::Resolved;
+	}
+
+	///	\brief Resolves the entries of a file loaded with LoadFlag::Lazy on first use
+	class Lazy_file final: public PathTable::Lazy_source
+	{
+	public:
+		inline Lazy_file(std::shared_ptr<Environment const> p_environment, std::shared_ptr<env_table const> p_variables, std::filesystem::path const& p_fileName, core::os_string_view const p_directoryPrefix, std::shared_ptr<Log_proxy> p_log)
+			: m_environment    {std::move(p_environment)}
+			, m_variables      {std::move(p_variables)}
+			, m_fileName       {p_fileName}
+			, m_directory      {p_fileName.parent_path()}
+			, m_directoryPrefix{p_directoryPrefix}
+			, m_log            {std::move(p_log)}
+		{}
+
+		bool resolve(PathTable::entry_t const& p_entry, std::filesystem::path& p_path) const final
+		{
+			load_state const state{.environment = *m_environment, .variables = *m_variables, .fileName = m_fileName, .directory = m_directory, .directoryPrefix = m_directoryPrefix};
+			resolve_scratch scratch;
+			PathTable::lazy_t const& lazy = *p_entry.lazy;
+			core::os_string_view path;
+			if(resolve_path(value_ref{.key = p_entry.key, .value = lazy.value, .line = lazy.line, .column = lazy.column}, state, scratch, *m_log, std::nullopt, path)
+				!= resolve_result::Resolved)
 			{
-				*(p_output++) = static_cast<char>(tchar >> 6  ) | static_cast<char>(0xC0);
-				*(p_output++) = static_cast<char>(tchar & 0x3F) | static_cast<char>(0x80);
+				return false;
 			}
-			else if(tchar < 0x00010000) //Level 2
+			p_path = std::filesystem::path{path};
+			return true;
+		}
+
+	private:
+		std::shared_ptr<Environment const> m_environment;
+		std::shared_ptr<env_table const> m_variables; //!< points into m_environment
+		std::filesystem::path m_fileName;
+		std::filesystem::path m_directory;
+		core::os_string       m_directoryPrefix;
+		std::shared_ptr<Log_proxy> m_log; //!< owned so that it outlives the proxy given to load
+	};
+
+	///	\brief Validates a key and resolves its value, except for the duplicate check which depends on the keys merged before it.
+	///	\note Thread safe as long as each thread has its own \p p_scratch
+	static void resolve_key(scef::keyedValue const& p_key, load_state const& p_state, resolve_scratch& p_scratch, resolved_key& p_out)
+	{
+		uint32_t const line   = static_cast<uint32_t>(p_key.line());
+		uint32_t const column = static_cast<uint32_t>(p_key.column());
+
+		std::u8string& key = p_scratch.keyBuffer;
+		{
+			std::u32string_view const key_sv = p_key.name();
+			key.resize(key_sv.size());
+
+			bool valid;
 			{
-				*(p_output++) = static_cast<char>( tchar >> 12        ) | static_cast<char>(0xE0);
-				*(p_output++) = static_cast<char>((tchar >>  6) & 0x3F) | static_cast<char>(0x80);
-				*(p_output++) = static_cast<char>( tchar        & 0x3F) | static_cast<char>(0x80);
+				Phase_timer const timer{p_state.profile ? &p_scratch.times.validate : nullptr};
+				valid = !key_sv.empty() && narrow_key(key_sv, key.data());
 			}
-			else if(tchar < 0x00110000) //Level 3
+
+			if(!valid)
 			{
-				*(p_output++) = static_cast<char>( tchar >> 18        ) | static_cast<char>(0xF0);
-				*(p_output++) = static_cast<char>((tchar >> 12) & 0x3F) | static_cast<char>(0x80);
-				*(p_output++) = static_cast<char>((tchar >>  6) & 0x3F) | static_cast<char>(0x80);
-				*(p_output++) = static_cast<char>( tchar        & 0x3F) | static_cast<char>(0x80);
+				PRELOG_CUSTOM(p_scratch.log, p_state.fileName.native(), line, column, logger::Level::Error,
+					"Invalid key \""sv, key_sv, '\"');
+				return;
 			}
-			else
+			p_out.validKey = true;
+		}
+
+		//whether the key is already defined is only known when merging, which then discards the diagnostics below
+		std::u32string_view const path_sv = p_key.value();
+
+		if(path_sv.empty())
+		{
+			PRELOG_CUSTOM(p_scratch.log, p_state.fileName.native(), line, column, logger::Level::Error,
+				"Invalid path \""sv, key, "\"=(empty)"sv);
+			p_out.key = key;
+			return;
+		}
+
+		uint64_t const value_hash = hash_value(path_sv, p_state.directory.native());
+		bool const env_dependent = path_sv.find(char32_t{0}) != std::u32string_view::npos;
+		uint32_t previous = PathTable::npos;
+
+		if(p_state.previous)
+		{
+			previous = p_state.previous.find(key);
+			if(previous != PathTable::npos)
 			{
-				if(tchar & 0x80000000)
+				//same value resolved against the same directory, no need to resolve it again
+				if(p_state.previous.value_hash(previous) == value_hash && !env_dependent)
 				{
-					*(p_output++) =  static_cast<char>(tchar >> 24);
-					*(p_output++) =  static_cast<char>(tchar >> 16);
-					*(p_output++) =  static_cast<char>(tchar >>  8);
-					*(p_output++) =  static_cast<char>(tchar      );
+					p_out.entry = p_state.previous.entry(previous, p_scratch.arena);
+					return;
 				}
-				else
+
+				//a lazy entry can not be compared without resolving it
+				if(p_state.previous.lazy(previous))
 				{
-					uint8_t leading = static_cast<uint8_t>(tchar >> 24);
-					switch(leading)
-					{
-					case 3:
-						*(p_output++) =  static_cast<char>(tchar >> 16);
-						[[fallthrough]];
-					case 2:
-						*(p_output++) =  static_cast<char>(tchar >>  8);
-						[[fallthrough]];
-					case 1:
-						*(p_output++) =  static_cast<char>(tchar      );
-						[[fallthrough]];
-					default:
-						break;
-					}
+					previous = PathTable::npos;
 				}
 			}
 		}
-	}
-#endif
-
 
-	static core::os_string convert_to_os(std::u32string_view p_str)
-	{
-		uintptr_t const size = convert_to_os_estimate(p_str);
-		if(size == 0)
+		if(p_state.lazy)
 		{
-			return {};
+			std::unique_ptr<PathTable::lazy_t> lazy = std::make_unique<PathTable::lazy_t>();
+			lazy->source = p_state.lazy;
+			lazy->value  = path_sv;
+			lazy->line   = line;
+			lazy->column = column;
+			p_out.entry = p_scratch.arena.make_lazy_entry(key, std::move(lazy), value_hash, env_dependent);
+			return;
 		}
 
-		core::os_string tstr;
-		tstr.resize(size);
-		convert_to_os_unsafe(p_str, tstr.data());
+		core::os_string_view setPath;
+		switch(resolve_path(value_ref{.key = key, .value = path_sv, .line = line, .column = column}, p_state, p_scratch, p_scratch.log,
+			previous != PathTable::npos ? std::optional{p_state.previous.path(previous)} : std::nullopt, setPath))
+		{
+		case resolve_result::Failed:
+			p_out.key = key;
+			return;
+		case resolve_result::Unchanged:
+			p_out.entry = p_state.previous.entry(previous, p_scratch.arena);
+			return;
+		case resolve_result::Resolved:
+			break;
+		}
 
-		return tstr;
+		p_out.entry = p_scratch.arena.make_entry(key, setPath, value_hash, env_dependent);
 	}
 
+	///	\brief Minimum number of keys given to a worker, below that the threads cost more than they save
+	static constexpr uintptr_t resolve_chunk = 1024;
+
 } //namespace
 
 
+struct PathFinder::Lazy_log
+{
+	Log_store  store;
+	std::mutex replay; //!< the store only supports a single consumer at a time
+};
 
+struct PathFinder::source_file
+{
+	std::filesystem::path fileName;  //!< absolute
+	std::filesystem::path cacheFile;
+	cache_source_t        cacheSource;
+	bool                  hasSourceInfo = false;
+	bool                  mapCache      = false;
+	bool                  prepared      = false;
+	Log_store             log;       //!< diagnostics emitted while preparing in parallel, replayed in order when merging
+	std::chrono::nanoseconds read {};
+	std::chrono::nanoseconds parse{};
+
+	std::shared_ptr<Mapped_table> mapped; //!< set if the cache could be mapped
+	std::optional<PathTable::entries_t> cached; //!< set if the cache could be read
+	std::optional<scef::document> document;     //!< parsed file otherwise, released as soon as its keys are resolved
+	std::shared_ptr<env_table const> variables; //!< referenced by document
+};
+
+
+bool PathFinder::load(std::filesystem::path const& p_fileName, Log_proxy& p_logProxy, LoadFlag const p_flags, Environment const* const p_environment)
+{
+	return load_files(std::span{&p_fileName, 1}, p_logProxy, p_flags, nullptr, nullptr, p_environment);
+}
 
-bool PathFinder::load(std::filesystem::path const& p_fileName, Log_proxy& p_logProxy)
+bool PathFinder::load(std::filesystem::path const& p_fileName, Log_proxy& p_logProxy, LoadFlag const p_flags, PathFinder const& p_previous, Environment const* const p_environment)
 {
-	bool input_absolute = p_fileName.is_absolute();
+	return load_files(std::span{&p_fileName, 1}, p_logProxy, p_flags, &p_previous, nullptr, p_environment);
+}
+
+bool PathFinder::load_layer(PathFinder const& p_base, std::filesystem::path const& p_fileName, Log_proxy& p_logProxy, LoadFlag const p_flags, Environment const* const p_environment)
+{
+	clear();
+	bool const empty_base = p_base.m_table.empty() && !p_base.m_mapped;
+	return load_files(std::span{&p_fileName, 1}, p_logProxy, p_flags, nullptr, empty_base ? nullptr : &p_base, p_environment);
+}
+
+bool PathFinder::load(std::span<std::filesystem::path const> const p_files, Log_proxy& p_logProxy, LoadFlag const p_flags, Environment const* const p_environment)
+{
+	return load_files(p_files, p_logProxy, p_flags, nullptr, nullptr, p_environment);
+}
+
+bool PathFinder::load_directory(std::filesystem::path const& p_directory, Log_proxy& p_logProxy, LoadFlag const p_flags, Environment const* const p_environment)
+{
+	std::vector<std::filesystem::path> files;
 	std::error_code ec;
-	std::filesystem::path const& fileName =
-		input_absolute ?
-		p_fileName :
-		std::filesystem::absolute(p_fileName, ec);
+	for(std::filesystem::directory_iterator it{p_directory, ec}, end; !ec && it != end; it.increment(ec))
+	{
+		if(it->path().extension() == ".scef" && it->is_regular_file(ec))
+		{
+			files.push_back(it->path());
+		}
+	}
 
-	if(!input_absolute && ec != std::error_code{})
+	if(ec != std::error_code{})
 	{
-		PRELOG_CUSTOM(p_logProxy, __OS_FILE__, static_cast<uint32_t>(__LINE__), 0, logger::Level::Error, "Unable to convert path \""sv, p_fileName, "\" to an absolute path"sv);
+		PRELOG_CUSTOM(p_logProxy, p_directory.native(), 0, 0, logger::Level::Error, "Unable to list directory"sv);
+		return false;
+	}
+	if(files.empty())
+	{
+		PRELOG_CUSTOM(p_logProxy, p_directory.native(), 0, 0, logger::Level::Error, "No \".scef\" file found in directory"sv);
 		return false;
 	}
 
-	std::filesystem::path directory = fileName.parent_path();
-	core::os_string_view filename_sv = fileName.native();
+	//fragments are layered by name, so that they can be ordered with a numeric prefix
+	std::sort(files.begin(), files.end(),
+		[](std::filesystem::path const& p_1, std::filesystem::path const& p_2)
+		{
+			return p_1.native() < p_2.native();
+		});
+
+	return load_files(files, p_logProxy, p_flags, nullptr, nullptr, p_environment);
+}
+
+bool PathFinder::load_files(std::span<std::filesystem::path const> const p_files, Log_proxy& p_logProxy, LoadFlag const p_flags, PathFinder const* const p_previous, PathFinder const* const p_base, Environment const* const p_environment)
+{
+	clock_t::time_point const start = clock_t::now();
+	m_stats = Load_stats{};
+	//indexes are about to change
+	m_directories.reset();
+	m_stats.files = p_files.size();
+
+	//a single snapshot per load, so that every value sees the same environment
+	//lazy entries are resolved after the load returns, so they keep their own copy
+	std::shared_ptr<Environment const> environment;
+	if(p_environment == nullptr)
+	{
+		environment = std::make_shared<Environment const>(Environment::capture());
+	}
+	else if(has_flag(p_flags, LoadFlag::Lazy))
+	{
+		environment = std::make_shared<Environment const>(*p_environment);
+	}
+	else
+	{
+		environment = std::shared_ptr<Environment const>{std::shared_ptr<Environment const>{}, p_environment};
+	}
 
-	scef::document pathFile;
+	if(p_base && p_base->m_lazyLog)
 	{
-		LogContext context{p_logProxy};
-		context.fileName = filename_sv;
+		//lazy entries of the base are shared, so are their diagnostics
+		m_lazyLog = p_base->m_lazyLog;
+	}
+	if(has_flag(p_flags, LoadFlag::Lazy) && !m_lazyLog)
+	{
+		m_lazyLog = std::make_shared<Lazy_log>();
+		m_lazyLog->store.set_filter(p_logProxy.min_level(), p_logProxy.max_count());
+	}
 
-		scef::Error t_err = pathFile.load(
-			fileName,
-			scef::Flag::DisableSpacers | scef::Flag::DisableComments | scef::Flag::ForceHeader,
-			SCEF_warning_callback, reinterpret_cast<void*>(&context));
+	//only a single file loaded into an empty table can be served from a mapping
+	bool const map_cache = has_all_flags(p_flags, LoadFlag::MapCache) && p_files.size() == 1 && m_table.empty() && !m_mapped && !p_base;
 
-		if(t_err != scef::Error::None)
-		{
-			scef::Error_Context const& t_error = pathFile.last_error();
-			format_SCEF_error(context, t_error);
-			return false;
-		}
+	std::vector<source_file> sources(p_files.size());
+	if(sources.size() == 1)
+	{
+		sources[0].mapCache = map_cache;
+		sources[0].prepared = prepare_file(p_files[0], p_logProxy, p_flags, *environment, true, sources[0]);
+	}
+	else
+	{
+		//caches are read in parallel, but files are only parsed right before being merged
+		//so that a single document is alive at a time instead of one per file
+		parallel_for(sources.size(),
+			[&](uintptr_t const p_index)
+			{
+				source_file& source = sources[p_index];
+				source.log.inherit_filter(p_logProxy);
+				source.prepared = prepare_file(p_files[p_index], source.log, p_flags, *environment, false, source);
+			});
 	}
 
-	scef::group* root_group = nullptr;
-	for(scef::itemProxy<scef::item> const& l1_item: pathFile.root())
+	//last file has precedence, it is merged first so that the other files see its keys as already defined
+	bool res = true;
+	for(uintptr_t i = sources.size(); i--;)
 	{
-		if(l1_item->type() != scef::ItemType::group)
+		source_file& source = sources[i];
+		source.log.replay(p_logProxy);
+		if(source.prepared && !source.mapped && !source.cached && !source.document)
 		{
-			WarnUnusedSCEFitem(p_logProxy, filename_sv, *l1_item);
-			continue;
+			source.prepared = parse_file(p_logProxy, *environment, source);
 		}
-		scef::group& group = *static_cast<scef::group*>(l1_item.get());
-		if(group.name() != U"pathfinder")
+		m_stats.read  += source.read;
+		m_stats.parse += source.parse;
+
+		if(!source.prepared || !merge_file(source, p_logProxy, p_flags, p_previous, p_base, environment))
 		{
-			WarnUnusedSCEFitem(p_logProxy, filename_sv, *l1_item);
-			continue;
+			++m_stats.errors;
+			res = false;
 		}
-		if(root_group)
+	}
+
+	if(p_base)
+	{
+		//keys of the base were skipped while merging, so the precedence of freeze does not matter here
+		Phase_timer const timer{&m_stats.build};
+		materialize();
+		if(p_base->m_mapped)
 		{
-			PRELOG_CUSTOM(p_logProxy, filename_sv, static_cast<uint32_t>(group.line()), static_cast<uint32_t>(group.column()), logger::Level::Warning,
-				"Multiple \"pathfinder\" groups specified in file (previously defined in "sv,
-				root_group->line(), ',', root_group->column(), ')');
+			m_table.freeze(p_base->m_mapped->image().to_entries());
 		}
-		else root_group = &group;
-
-		for(scef::itemProxy<scef::item> const& l2_item : group)
+		else
 		{
-			if(l2_item->type() != scef::ItemType::key_value)
+			PathTable::entries_t shared;
+			shared.reserve(p_base->m_table.size());
+			for(uint32_t i = 0, size = p_base->m_table.size(); i < size; ++i)
 			{
-				WarnUnusedSCEFitem(p_logProxy, filename_sv, *l2_item);
-				continue;
+				shared.push_back(p_base->m_table.entry(i));
 			}
+			m_table.freeze(std::move(shared));
+		}
+	}
+
+	m_stats.bytes = m_mapped ? m_mapped->image().image_size() : m_table.memory_usage();
+	m_stats.total = elapsed_since(start);
+	return res;
+}
 
-			validate_and_push(*static_cast<scef::keyedValue*>(l2_item.get()), directory, p_logProxy, fileName);
+bool PathFinder::prepare_file(std::filesystem::path const& p_fileName, Log_proxy& p_logProxy, LoadFlag const p_flags, Environment const& p_environment, bool const p_parse, source_file& p_source)
+{
+	bool input_absolute = p_fileName.is_absolute();
+	std::error_code ec;
+	p_source.fileName =
+		input_absolute ?
+		p_fileName :
+		std::filesystem::absolute(p_fileName, ec);
+
+	if(!input_absolute && ec != std::error_code{})
+	{
+		PRELOG_CUSTOM(p_logProxy, __OS_FILE__, static_cast<uint32_t>(__LINE__), 0, logger::Level::Error, "Unable to convert path \""sv, p_fileName, "\" to an absolute path"sv);
+		return false;
+	}
+
+	std::filesystem::path const& fileName = p_source.fileName;
+
+	if(has_flag(p_flags, LoadFlag::UseCache))
+	{
+		Phase_timer const timer{&p_source.read};
+		p_source.cacheFile = cache_file_name(fileName);
+		p_source.hasSourceInfo = cache_source_info(fileName, has_all_flags(p_flags, LoadFlag::VerifyCache), p_source.cacheSource);
+
+		if(p_source.hasSourceInfo)
+		{
+			if(p_source.mapCache)
+			{
+				std::shared_ptr<Mapped_table> mapped = std::make_shared<Mapped_table>();
+				if(mapped->open(p_source.cacheFile, p_source.cacheSource, p_environment))
+				{
+					p_source.mapped = std::move(mapped);
+					return true;
+				}
+			}
+			else
+			{
+				PathTable::entries_t entries;
+				if(read_cache(p_source.cacheFile, p_source.cacheSource, p_environment, entries))
+				{
+					p_source.cached.emplace(std::move(entries));
+					return true;
+				}
+			}
 		}
 	}
 
-	if(root_group == nullptr)
+	return !p_parse || parse_file(p_logProxy, p_environment, p_source);
+}
+
+bool PathFinder::parse_file(Log_proxy& p_logProxy, Environment const& p_environment, source_file& p_source)
+{
+	std::filesystem::path const& fileName = p_source.fileName;
+	LogContext context{p_logProxy};
+	context.fileName = fileName.native();
+
+	scef::document& document = p_source.document.emplace();
+	scef::Error t_err;
 	{
-		PRELOG_CUSTOM(p_logProxy, filename_sv, 0, 0, logger::Level::Error, "No \"pathfinder\" group specified in file"sv);
+		Phase_timer const timer{&p_source.parse};
+		t_err = document.load(
+			fileName,
+			scef::Flag::DisableSpacers | scef::Flag::DisableComments | scef::Flag::ForceHeader,
+			SCEF_warning_callback, reinterpret_cast<void*>(&context));
+	}
+
+	if(t_err != scef::Error::None)
+	{
+		scef::Error_Context const& t_error = document.last_error();
+		format_SCEF_error(context, t_error);
+		p_source.document.reset();
 		return false;
 	}
 
+	p_source.variables = intern_environment(document, p_environment);
 	return true;
 }
 
-
-void PathFinder::validate_and_push(scef::keyedValue const& p_key, std::filesystem::path const& p_directory, Log_proxy& p_logProxy, std::filesystem::path const& p_fileName)
+bool PathFinder::merge_file(source_file& p_source, Log_proxy& p_logProxy, LoadFlag const p_flags, PathFinder const* const p_previous, PathFinder const* const p_base, std::shared_ptr<Environment const> const& p_environment)
 {
-	if(!validateKey(p_key.name()))
+	if(p_source.mapped)
 	{
-		PRELOG_CUSTOM(p_logProxy, p_fileName.native(), static_cast<uint32_t>(p_key.line()), static_cast<uint32_t>(p_key.column()), logger::Level::Error,
-			"Invalid key \""sv, p_key.name(), '\"');
-		return;
+		m_mapped = std::move(p_source.mapped);
+		++m_stats.cached;
+		m_stats.entries += m_mapped->image().size();
+		return true;
 	}
 
-	std::u8string key;
+	if(p_source.cached.has_value())
 	{
-		std::u32string_view key_sv = p_key.name();
-		key.resize(key_sv.size());
-
-		for(uintptr_t i = 0, size = key_sv.size(); i < size; ++i)
+		Phase_timer const timer{&m_stats.build};
+		++m_stats.cached;
+		m_stats.entries += p_source.cached->size();
+		if(p_base)
 		{
-			key[i] = static_cast<char8_t>(key_sv[i]);
+			std::erase_if(p_source.cached.value(), [p_base](PathTable::entry_ptr const& p_entry) { return p_base->find(p_entry->key, p_entry->hash) != PathTable::npos; });
 		}
+		//entries of a mapped cache can not be shared, they are copied out of the image either way
+		if(p_previous && !p_previous->m_mapped)
+		{
+			p_previous->m_table.share_unchanged(p_source.cached.value());
+		}
+		materialize();
+		m_table.freeze(std::move(p_source.cached.value()));
+		return true;
 	}
 
-	if(m_pathTable.find(key) != m_pathTable.end())
+	std::filesystem::path const& fileName = p_source.fileName;
+	std::filesystem::path const directory = fileName.parent_path();
+	core::os_string_view const filename_sv = fileName.native();
+
+	bool const lazy = has_flag(p_flags, LoadFlag::Lazy);
+	//lazy entries have no path to store yet
+	bool const store_cache = has_flag(p_flags, LoadFlag::UseCache) && !lazy;
+
+	core::os_string directoryPrefix = directory.native();
+	if(!directoryPrefix.empty() && directoryPrefix.back() != std::filesystem::path::preferred_separator)
 	{
-		PRELOG_CUSTOM(p_logProxy, p_fileName.native(), static_cast<uint32_t>(p_key.line()), static_cast<uint32_t>(p_key.column()), logger::Level::Warning,
-			"Key \""sv, key, "\" already defined. Will be ignored!"sv);
-		return;
+		directoryPrefix.push_back(std::filesystem::path::preferred_separator);
 	}
 
-	std::u32string_view path_sv = p_key.value();
-
-	if(path_sv.empty())
+	load_state state{.environment = *p_environment, .variables = *p_source.variables, .fileName = fileName, .directory = directory, .directoryPrefix = directoryPrefix};
+	if(p_previous)
 	{
-		PRELOG_CUSTOM(p_logProxy, p_fileName.native(), static_cast<uint32_t>(p_key.line()), static_cast<uint32_t>(p_key.column()), logger::Level::Error,
-			"Invalid path \""sv, key, "\"=(empty)"sv);
-		return;
+		state.previous = p_previous->m_mapped ?
+			previous_entries{.table = nullptr, .image = &p_previous->m_mapped->image()} :
+			previous_entries{.table = &p_previous->m_table, .image = nullptr};
+	}
+	if(lazy)
+	{
+		state.lazy = std::make_shared<Lazy_file const>(p_environment, p_source.variables, fileName, directoryPrefix, std::shared_ptr<Log_proxy>{m_lazyLog, &m_lazyLog->store});
 	}
+	state.profile = has_flag(p_flags, LoadFlag::Profile);
 
-	core::os_string partialPath;
+	PathTable::entries_t entries;
+	bool shadowed = false; //!< entries holds keys defined by a file of higher precedence
+	scef::group const* root_group = nullptr;
 	{
-		uintptr_t pos = 0;;
-		pos = path_sv.find(char32_t{0});
-		while(pos != core::os_string_view::npos)
+		//the document is walked first to know what to report and resolve in document order,
+		//keys are then resolved in parallel and merged back in that order so that diagnostics come out as if resolved one by one
+		struct step_t
 		{
-			if(pos != 0)
+			enum class Action: uint8_t
+			{
+				Unused,
+				MultipleGroups,
+				Key,
+			};
+
+			scef::item const*  item;
+			scef::group const* previousGroup;
+			Action             action;
+		};
+
+		std::vector<step_t> steps;
+		std::vector<scef::keyedValue const*> keys;
+		for(scef::itemProxy<scef::item> const& l1_item: p_source.document->root())
+		{
+			if(l1_item->type() != scef::ItemType::group)
+			{
+				steps.push_back(step_t{.item = l1_item.get(), .previousGroup = nullptr, .action = step_t::Action::Unused});
+				continue;
+			}
+			scef::group& group = *static_cast<scef::group*>(l1_item.get());
+			if(group.name() != U"pathfinder")
+			{
+				steps.push_back(step_t{.item = l1_item.get(), .previousGroup = nullptr, .action = step_t::Action::Unused});
+				continue;
+			}
+			if(root_group)
 			{
-				std::u32string_view aux = path_sv.substr(0, pos);
-				core::os_string tSequence{convert_to_os(aux)};
+				steps.push_back(step_t{.item = &group, .previousGroup = root_group, .action = step_t::Action::MultipleGroups});
+			}
+			else root_group = &group;
 
-				if(tSequence.empty())
+			for(scef::itemProxy<scef::item> const& l2_item : group)
+			{
+				if(l2_item->type() != scef::ItemType::key_value)
 				{
-					PRELOG_CUSTOM(p_logProxy, p_fileName.native(), static_cast<uint32_t>(p_key.line()), static_cast<uint32_t>(p_key.column()), logger::Level::Error,
-						"Invalid path element \""sv, aux,  "\" in key \""sv,  key, '\"');
-					return;
+					steps.push_back(step_t{.item = l2_item.get(), .previousGroup = nullptr, .action = step_t::Action::Unused});
+					continue;
 				}
-				partialPath += tSequence;
-			}
 
-			path_sv = path_sv.substr(pos + 1);
+				steps.push_back(step_t{.item = l2_item.get(), .previousGroup = nullptr, .action = step_t::Action::Key});
+				keys.push_back(static_cast<scef::keyedValue const*>(l2_item.get()));
+			}
+		}
 
-			pos = path_sv.find(char32_t{0});
+		std::vector<resolved_key> resolved(keys.size());
+		uintptr_t const workers = std::clamp<uintptr_t>(keys.size() / resolve_chunk, 1, std::max(std::thread::hardware_concurrency(), 1u));
+		std::vector<resolve_scratch> scratch(workers);
+		for(resolve_scratch& local : scratch)
+		{
+			local.log.inherit_filter(p_logProxy);
+		}
 
-			if(pos == core::os_string_view::npos)
-			{
-				PRELOG_CUSTOM(p_logProxy, p_fileName.native(), static_cast<uint32_t>(p_key.line()), static_cast<uint32_t>(p_key.column()), logger::Level::Error,
-					"Bad environment delimiters in \""sv, key, '\"');
-				return;
-			}
+		{
+			Phase_timer const timer{&m_stats.resolve};
+			parallel_for(workers,
+				[&](uintptr_t const p_worker)
+				{
+					resolve_scratch& local = scratch[p_worker];
+					for(uintptr_t i = keys.size() * p_worker / workers, end = keys.size() * (p_worker + 1) / workers; i < end; ++i)
+					{
+						resolved_key& res = resolved[i];
+						res.worker   = static_cast<uint32_t>(p_worker);
+						res.logBegin = static_cast<uint32_t>(local.log.size());
+						resolve_key(*keys[i], state, local, res);
+						res.logEnd   = static_cast<uint32_t>(local.log.size());
+					}
+				});
+		}
 
-			std::u32string_view env_val = path_sv.substr(0, pos);
+		Phase_timer const timer{&m_stats.build};
 
-			++pos;
-			pos = path_sv.find(char32_t{0}, pos);
-			
-			if(env_val.empty())
+		//a key defined several times in a file keeps its first definition that could be resolved,
+		//found up front by sorting indexes so that nothing needs to be indexed per entry while merging
+		{
+			std::vector<uint32_t> order;
+			order.reserve(resolved.size());
+			for(uint32_t i = 0, size = static_cast<uint32_t>(resolved.size()); i < size; ++i)
 			{
-				continue;
+				if(resolved[i].validKey)
+				{
+					order.push_back(i);
+				}
 			}
+			std::stable_sort(order.begin(), order.end(),
+				[&resolved](uint32_t const p_1, uint32_t const p_2)
+				{
+					return resolved[p_1].name() < resolved[p_2].name();
+				});
 
-			core::os_string tenvKey{convert_to_os(env_val)};
-
-			if(tenvKey.empty())
+			for(uintptr_t i = 0, size = order.size(); i < size; )
 			{
-				PRELOG_CUSTOM(p_logProxy, p_fileName.native(), static_cast<uint32_t>(p_key.line()), static_cast<uint32_t>(p_key.column()), logger::Level::Error,
-					"Invalid environment variable \""sv, env_val, "\" in key \""sv, key, '\"');
-				return;
+				std::u8string_view const name = resolved[order[i]].name();
+				bool kept = false;
+				for(; i < size && resolved[order[i]].name() == name; ++i)
+				{
+					resolved_key& res = resolved[order[i]];
+					res.duplicate = kept;
+					kept = kept || res.entry != nullptr;
+				}
 			}
+		}
 
+		entries.reserve(resolved.size());
+		uintptr_t next_key = 0;
+		for(step_t const& step : steps)
+		{
+			switch(step.action)
 			{
-				std::optional<core::os_string> res = core::get_env(tenvKey);
-
-				if(!res.has_value())
+			case step_t::Action::Unused:
+				WarnUnusedSCEFitem(p_logProxy, filename_sv, *step.item);
+				break;
+			case step_t::Action::MultipleGroups:
+				PRELOG_CUSTOM(p_logProxy, filename_sv, static_cast<uint32_t>(step.item->line()), static_cast<uint32_t>(step.item->column()), logger::Level::Warning,
+					"Multiple \"pathfinder\" groups specified in file (previously defined in "sv,
+					step.previousGroup->line(), ',', step.previousGroup->column(), ')');
+				break;
+			case step_t::Action::Key:
 				{
-					PRELOG_CUSTOM(p_logProxy, p_fileName.native(), static_cast<uint32_t>(p_key.line()), static_cast<uint32_t>(p_key.column()), logger::Level::Warning,
-						"Environment variable \""sv, env_val, "\" not found"sv);
-					continue;
-				}
+					resolved_key& res = resolved[next_key++];
+					if(res.validKey)
+					{
+						std::u8string_view const key = res.name();
+						if(res.duplicate || defined(key, p_base))
+						{
+							PRELOG_CUSTOM(p_logProxy, filename_sv, static_cast<uint32_t>(step.item->line()), static_cast<uint32_t>(step.item->column()), logger::Level::Warning,
+								"Key \""sv, key, "\" already defined. Will be ignored!"sv);
+							++m_stats.duplicates;
+							//the cache of this file still needs the entry, it is dropped once the cache is written
+							if(!res.duplicate && res.entry)
+							{
+								entries.push_back(std::move(res.entry));
+								shadowed = true;
+							}
+							break;
+						}
+					}
 
-				partialPath += res.value();
+					scratch[res.worker].log.replay(p_logProxy, res.logBegin, res.logEnd);
+					if(res.entry)
+					{
+						entries.push_back(std::move(res.entry));
+					}
+					else
+					{
+						++m_stats.errors;
+					}
+				}
+				break;
 			}
 		}
 
-		//get remaining
-		if(!path_sv.empty())
+		for(resolve_scratch& local : scratch)
 		{
-			core::os_string tSequence{convert_to_os(path_sv)};
+			m_stats.validate  += local.times.validate;
+			m_stats.expand    += local.times.assemble - local.times.convert;
+			m_stats.convert   += local.times.convert;
+			m_stats.normalize += local.times.normalize;
+		}
+	}
+
+	Phase_timer const timer{&m_stats.build};
+
+	//the entries were built while the document was alive, releasing it here only keeps it from coexisting
+	//with the buffers of freeze and of the cache being written
+	p_source.document.reset();
+
+	std::sort(entries.begin(), entries.end(),
+		[](PathTable::entry_ptr const& p_1, PathTable::entry_ptr const& p_2)
+		{
+			return p_1->key < p_2->key;
+		});
+	m_stats.entries += entries.size();
+
+	if(root_group == nullptr)
+	{
+		PRELOG_CUSTOM(p_logProxy, filename_sv, 0, 0, logger::Level::Error, "No \"pathfinder\" group specified in file"sv);
+		return false;
+	}
 
-			if(tSequence.empty())
+	if(store_cache && p_source.hasSourceInfo && cache_directory_failed(p_source.cacheFile))
+	{
+		//a read-only directory is only warned about once, see below
+		PRELOG_CUSTOM(p_logProxy, filename_sv, 0, 0, logger::Level::Debug, "Cache file \""sv, p_source.cacheFile, "\" not written, its directory could not be written to before"sv);
+	}
+	else if(store_cache && p_source.hasSourceInfo)
+	{
+		//the table is ordered by the names as written in the file, the cache by their native form
+		std::vector<core::os_string_view> envViews;
+		envViews.reserve(p_source.variables->variables.size());
+		for(decltype(env_table::variables)::value_type const& variable : p_source.variables->variables)
+		{
+			if(!variable.second.name.empty())
 			{
-				PRELOG_CUSTOM(p_logProxy, p_fileName.native(), static_cast<uint32_t>(p_key.line()), static_cast<uint32_t>(p_key.column()), logger::Level::Error,
-					"Invalid path element \""sv, path_sv, "\" in key \""sv, key, '\"');
-				return;
+				envViews.push_back(variable.second.name);
 			}
+		}
+		std::sort(envViews.begin(), envViews.end());
 
-			partialPath += tSequence;
+		if(!write_cache(p_source.cacheFile, p_source.cacheSource, *p_environment, envViews, entries))
+		{
+			logger::Level const level = mark_cache_directory_failed(p_source.cacheFile) ? logger::Level::Warning : logger::Level::Debug;
+			PRELOG_CUSTOM(p_logProxy, filename_sv, 0, 0, level, "Unable to write cache file \""sv, p_source.cacheFile, "\", caches will not be written to its directory anymore"sv);
+		}
+		else if(p_source.mapCache)
+		{
+			//switch to the freshly written cache so that its pages are shared with other processes
+			std::shared_ptr<Mapped_table> mapped = std::make_shared<Mapped_table>();
+			if(mapped->open(p_source.cacheFile, p_source.cacheSource, *p_environment))
+			{
+				m_mapped = std::move(mapped);
+				return true;
+			}
 		}
 	}
 
-	std::filesystem::path setPath {static_cast<std::basic_string<core::os_char>&>(partialPath)};
+	//keys already in the table take precedence in freeze, only the ones of the base need to be removed
+	if(shadowed && p_base)
+	{
+		std::erase_if(entries, [p_base](PathTable::entry_ptr const& p_entry) { return p_base->find(p_entry->key, p_entry->hash) != PathTable::npos; });
+	}
 
-	if(!setPath.is_absolute())
+	materialize();
+	m_table.freeze(std::move(entries));
+	return true;
+}
+
+
+bool PathFinder::defined(std::u8string_view const p_key, PathFinder const* const p_base) const
+{
+	uint64_t const t_hash = PathTable::hash(p_key);
+	return find(p_key, t_hash) != PathTable::npos || (p_base && p_base->find(p_key, t_hash) != PathTable::npos);
+}
+
+void PathFinder::clear()
+{
+	m_directories.reset();
+	m_table.clear();
+	m_mapped.reset();
+	m_lazyLog.reset();
+}
+
+void PathFinder::materialize()
+{
+	if(!m_mapped)
+	{
+		return;
+	}
+
+	PathTable::entries_t entries = m_mapped->image().to_entries();
+	m_mapped.reset();
+	m_table.freeze(std::move(entries));
+}
+
+uint32_t PathFinder::find(std::u8string_view const p_name, uint64_t const p_hash) const
+{
+	if(m_mapped)
+	{
+		return m_mapped->image().find(p_name, p_hash);
+	}
+	return m_table.find(p_name, p_hash);
+}
+
+std::filesystem::path const& PathFinder::path_at(uint32_t const p_index) const
+{
+	if(m_mapped)
 	{
-		setPath = p_directory / setPath;
+		return m_mapped->path(p_index);
 	}
-	setPath = setPath.lexically_normal();
+	return m_table[p_index].resolved_path();
+}
 
-	m_pathTable.emplace(std::move(key), std::move(setPath));
+core::os_string_view PathFinder::path_view_at(uint32_t const p_index) const
+{
+	if(m_mapped)
+	{
+		return m_mapped->image().path(p_index);
+	}
+	return m_table[p_index].resolved_native();
+}
+
+int PathFinder::directory_at(uint32_t const p_index) const
+{
+	uint32_t const count = m_mapped ? m_mapped->image().size() : m_table.size();
+	return m_directories.open(p_index, count, path_view_at(p_index).data());
+}
+
+std::shared_ptr<std::filesystem::path const> PathFinder::shared_path_at(uint32_t const p_index) const
+{
+	if(m_mapped)
+	{
+		return std::shared_ptr<std::filesystem::path const>{m_mapped, &m_mapped->path(p_index)};
+	}
+	return std::shared_ptr<std::filesystem::path const>{m_table.entry(p_index), &m_table[p_index].resolved_path()};
+}
+
+std::u8string_view PathFinder::u8path_at(uint32_t const p_index) const
+{
+	if(m_mapped)
+	{
+		return m_mapped->u8path(p_index);
+	}
+	return m_table[p_index].resolved_u8path();
+}
+
+std::u8string_view PathFinder::key_at(uint32_t const p_index) const
+{
+	if(m_mapped)
+	{
+		return m_mapped->image().key(p_index);
+	}
+	return m_table[p_index].key;
 }
 
 std::filesystem::path const& PathFinder::get_path(std::u8string_view const p_name) const
 {
-	decltype(m_pathTable)::const_iterator it = m_pathTable.find(p_name);
-	if(it != m_pathTable.end())
+	uint32_t const index = find(p_name, PathTable::hash(p_name));
+	if(index != PathTable::npos)
 	{
-		return it->second;
+		return path_at(index);
 	}
 	return emptyPath;
 }
 
+core::os_string_view PathFinder::get_path_view(std::u8string_view const p_name) const
+{
+	uint32_t const index = find(p_name, PathTable::hash(p_name));
+	if(index != PathTable::npos)
+	{
+		return path_view_at(index);
+	}
+	return {};
+}
+
+uintptr_t PathFinder::get_paths(std::span<std::u8string_view const> const p_names, std::span<std::filesystem::path const*> const p_paths, std::span<uint64_t> const p_missed) const
+{
+	std::fill(p_missed.begin(), p_missed.end(), uint64_t{0});
+
+	constexpr uintptr_t chunk_size = 64;
+	uint32_t indexes[chunk_size];
+	uintptr_t missed = 0;
+
+	for(uintptr_t base = 0, size = p_names.size(); base < size; base += chunk_size)
+	{
+		uintptr_t const count = std::min(chunk_size, size - base);
+		if(m_mapped)
+		{
+			for(uintptr_t i = 0; i < count; ++i)
+			{
+				indexes[i] = find(p_names[base + i], PathTable::hash(p_names[base + i]));
+			}
+		}
+		else
+		{
+			m_table.find(p_names.subspan(base, count), std::span<uint32_t>{indexes, count});
+		}
+
+		for(uintptr_t i = 0; i < count; ++i)
+		{
+			if(indexes[i] == PathTable::npos)
+			{
+				p_paths[base + i] = &emptyPath;
+				if(!p_missed.empty())
+				{
+					p_missed[(base + i) / 64] |= uint64_t{1} << ((base + i) % 64);
+				}
+				++missed;
+			}
+			else
+			{
+				p_paths[base + i] = &path_at(indexes[i]);
+			}
+		}
+	}
+	return missed;
+}
+
+bool PathFinder::resolve_all(Log_proxy& p_logProxy) const
+{
+	//nothing was loaded with LoadFlag::Lazy, a mapped cache is never lazy either
+	if(!m_lazyLog)
+	{
+		return true;
+	}
+
+	bool res = true;
+	for(uint32_t i = 0, size = m_table.size(); i < size; ++i)
+	{
+		PathTable::entry_t const& entry = m_table[i];
+		if(entry.lazy && entry.resolved_path().empty())
+		{
+			res = false;
+		}
+	}
+
+	std::lock_guard const lock{m_lazyLog->replay};
+	m_lazyLog->store.replay(p_logProxy);
+	return res;
+}
+
 } //namespace pathfinder
@@ -0,0 +1,615 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include "pathfinder_cache.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <random>
+#include <set>
+#include <string>
+
+namespace pathfinder
+{
+namespace
+{
+	static constexpr char cache_magic[8] = {'P', 'F', 'C', 'A', 'C', 'H', 'E', '\0'};
+
+	static std::mutex                g_failedMutex;
+	static std::set<core::os_string> g_failedDirectories; //!< where a cache could not be written, guarded by g_failedMutex
+
+	static inline uint64_t hash_mix(uint64_t const p_hash, uint64_t const p_value)
+	{
+		uint64_t res = (p_hash ^ p_value) * 0x9E3779B97F4A7C15;
+		return res ^ (res >> 32);
+	}
+
+	static uint64_t hash_bytes(std::span<std::byte const> const p_data)
+	{
+		uint64_t res = hash_mix(0xCBF29CE484222325, p_data.size());
+		std::byte const* data = p_data.data();
+		uintptr_t remaining = p_data.size();
+
+		for(; remaining >= sizeof(uint64_t); remaining -= sizeof(uint64_t), data += sizeof(uint64_t))
+		{
+			uint64_t word;
+			memcpy(&word, data, sizeof(uint64_t));
+			res = hash_mix(res, word);
+		}
+
+		if(remaining)
+		{
+			uint64_t word = 0;
+			memcpy(&word, data, remaining);
+			res = hash_mix(res, word);
+		}
+		return res;
+	}
+
+	template<typename T>
+	static inline std::span<std::byte const> as_bytes(std::basic_string_view<T> const p_str)
+	{
+		return std::as_bytes(std::span<T const>{p_str.data(), p_str.size()});
+	}
+
+	static inline uint64_t align8(uint64_t const p_val)
+	{
+		return (p_val + 7) & ~uint64_t{7};
+	}
+
+#ifdef _WIN32
+	///	\brief Deletes the caches of \p p_cacheFile that were moved out of the way by write_cache, unless they are still mapped
+	static void remove_stale_caches(std::filesystem::path const& p_cacheFile)
+	{
+		std::wstring const prefix = p_cacheFile.filename().native() + L'.';
+		std::error_code ec;
+		for(std::filesystem::directory_iterator it{p_cacheFile.parent_path(), ec}, end; !ec && it != end; it.increment(ec))
+		{
+			std::wstring const name = it->path().filename().native();
+			if(name.starts_with(prefix) && name.ends_with(L".stale"))
+			{
+				std::error_code removed;
+				std::filesystem::remove(it->path(), removed);
+			}
+		}
+	}
+#endif
+
+	static inline bool in_range(std::span<std::byte const> const p_image, uint64_t const p_offset, uint64_t const p_size)
+	{
+		return p_offset <= p_image.size() && p_size <= p_image.size() - p_offset;
+	}
+} //namespace
+
+
+bool Cache_image::open(std::span<std::byte const> const p_image)
+{
+	m_image = {};
+	if(p_image.size() < sizeof(header_t) || reinterpret_cast<uintptr_t>(p_image.data()) % alignof(header_t))
+	{
+		return false;
+	}
+
+	header_t const* const header = reinterpret_cast<header_t const*>(p_image.data());
+	if(memcmp(header->magic, cache_magic, sizeof(cache_magic)) ||
+		header->version != version ||
+		header->os_char_size != sizeof(core::os_char) ||
+		header->total_size != p_image.size() ||
+		!std::has_single_bit(header->slot_count) ||
+		header->slot_count < header->entry_count * uint64_t{2})
+	{
+		return false;
+	}
+
+	uint64_t const env_offset     = sizeof(header_t);
+	uint64_t const slots_offset   = env_offset   + header->env_count   * uint64_t{sizeof(env_t)};
+	uint64_t const entries_offset = slots_offset + header->slot_count  * uint64_t{sizeof(slot_t)};
+	uint64_t const strings_offset = entries_offset + header->entry_count * uint64_t{sizeof(entry_t)};
+
+	if(strings_offset > p_image.size())
+	{
+		return false;
+	}
+
+	//the header and the environment table are read in full by up_to_date either way
+	std::span<std::byte const> const hashed[] = {
+		p_image.subspan(0, offsetof(header_t, header_hash)),
+		p_image.subspan(env_offset, slots_offset - env_offset)};
+	if(hash_mix(hash_bytes(hashed[0]), hash_bytes(hashed[1])) != header->header_hash)
+	{
+		return false;
+	}
+
+	env_t const* const env = reinterpret_cast<env_t const*>(p_image.data() + env_offset);
+	for(uint32_t i = 0; i < header->env_count; ++i)
+	{
+		if(!in_range(p_image, env[i].name_offset, env[i].name_size * sizeof(core::os_char)) ||
+			env[i].name_offset % alignof(core::os_char))
+		{
+			return false;
+		}
+	}
+
+	m_image   = p_image;
+	m_header  = header;
+	m_env     = env;
+	m_slots   = reinterpret_cast<slot_t  const*>(p_image.data() + slots_offset);
+	m_entries = reinterpret_cast<entry_t const*>(p_image.data() + entries_offset);
+	return true;
+}
+
+bool Cache_image::up_to_date(cache_source_t const& p_source, Environment const& p_environment) const
+{
+	if(m_image.empty() ||
+		m_header->source_size      != p_source.size ||
+		m_header->source_mtime     != p_source.mtime ||
+		(p_source.content_hash != 0 && m_header->source_hash != p_source.content_hash) ||
+		m_header->source_path_hash != p_source.path_hash)
+	{
+		return false;
+	}
+
+	std::vector<core::os_string_view> names;
+	names.reserve(m_header->env_count);
+	for(uint32_t i = 0; i < m_header->env_count; ++i)
+	{
+		names.emplace_back(reinterpret_cast<core::os_char const*>(m_image.data() + m_env[i].name_offset), m_env[i].name_size);
+	}
+
+	return environment_fingerprint(names, p_environment) == m_header->env_fingerprint;
+}
+
+uint32_t Cache_image::find(std::u8string_view const p_key, uint64_t const p_hash) const
+{
+	if(m_image.empty())
+	{
+		return PathTable::npos;
+	}
+
+	uint64_t const mask = m_header->slot_count - 1;
+	uint32_t const tag = static_cast<uint32_t>(p_hash >> 32);
+	//slots are not validated by open, probes are bounded should no slot be empty
+	for(uint64_t pos = p_hash & mask, probes = 0; probes <= mask; pos = (pos + 1) & mask, ++probes)
+	{
+		slot_t const& slot = m_slots[pos];
+		if(slot.index == PathTable::npos || slot.index >= m_header->entry_count)
+		{
+			return PathTable::npos;
+		}
+		if(slot.tag == tag && key(slot.index) == p_key)
+		{
+			return slot.index;
+		}
+	}
+	return PathTable::npos;
+}
+
+std::u8string_view Cache_image::key(uint32_t const p_index) const
+{
+	entry_t const& entry = m_entries[p_index];
+	if(!in_range(m_image, entry.key_offset, entry.key_size))
+	{
+		return {};
+	}
+	return std::u8string_view{reinterpret_cast<char8_t const*>(m_image.data() + entry.key_offset), entry.key_size};
+}
+
+core::os_string_view Cache_image::path(uint32_t const p_index) const
+{
+	entry_t const& entry = m_entries[p_index];
+	if(!in_range(m_image, entry.path_offset, (uint64_t{entry.path_size} + 1) * sizeof(core::os_char)) ||
+		entry.path_offset % alignof(core::os_char))
+	{
+		return {};
+	}
+
+	core::os_char const* const data = reinterpret_cast<core::os_char const*>(m_image.data() + entry.path_offset);
+	if(data[entry.path_size] != 0)
+	{
+		return {};
+	}
+	return core::os_string_view{data, entry.path_size};
+}
+
+
+PathTable::entries_t Cache_image::to_entries() const
+{
+	PathTable::entries_t res;
+	res.reserve(size());
+	PathTable::Entry_arena arena;
+	bool sorted = true;
+	for(uint32_t i = 0, count = size(); i < count; ++i)
+	{
+		std::u8string_view const entry_key = key(i);
+		core::os_string_view const entry_path = path(i);
+		if(entry_key.empty() || entry_path.empty())
+		{
+			continue;
+		}
+		sorted = sorted && (res.empty() || res.back()->key < entry_key);
+
+		res.push_back(arena.make_entry(entry_key, entry_path, value_hash(i), env_dependent(i)));
+	}
+
+	//the order was not validated by open, tables require sorted unique keys
+	if(!sorted)
+	{
+		auto const by_key = [](PathTable::entry_ptr const& p_1, PathTable::entry_ptr const& p_2) { return p_1->key < p_2->key; };
+		std::stable_sort(res.begin(), res.end(), by_key);
+		res.erase(std::unique(res.begin(), res.end(),
+			[](PathTable::entry_ptr const& p_1, PathTable::entry_ptr const& p_2) { return p_1->key == p_2->key; }), res.end());
+	}
+	return res;
+}
+
+Mapped_table::~Mapped_table()
+{
+	if(m_paths)
+	{
+		for(uint32_t i = 0, size = m_image.size(); i < size; ++i)
+		{
+			delete m_paths[i].load(std::memory_order_relaxed);
+		}
+	}
+#ifdef _WIN32
+	if(m_u8paths)
+	{
+		for(uint32_t i = 0, size = m_image.size(); i < size; ++i)
+		{
+			delete m_u8paths[i].load(std::memory_order_relaxed);
+		}
+	}
+#endif
+}
+
+bool Mapped_table::open(std::filesystem::path const& p_cacheFile, cache_source_t const& p_source, Environment const& p_environment)
+{
+	if(!m_mapping.map(p_cacheFile))
+	{
+		return false;
+	}
+
+	if(!m_image.open(m_mapping.data()) || !m_image.up_to_date(p_source, p_environment))
+	{
+		m_image = Cache_image{};
+		m_mapping.unmap();
+		return false;
+	}
+
+	m_paths = std::make_unique<std::atomic<std::filesystem::path const*>[]>(m_image.size());
+#ifdef _WIN32
+	m_u8paths = std::make_unique<std::atomic<std::u8string const*>[]>(m_image.size());
+#endif
+	return true;
+}
+
+std::filesystem::path const& Mapped_table::path(uint32_t const p_index) const
+{
+	std::atomic<std::filesystem::path const*>& slot = m_paths[p_index];
+	std::filesystem::path const* res = slot.load(std::memory_order_acquire);
+	if(res)
+	{
+		return *res;
+	}
+
+	std::filesystem::path const* const created = new std::filesystem::path{m_image.path(p_index)};
+	if(slot.compare_exchange_strong(res, created, std::memory_order_acq_rel, std::memory_order_acquire))
+	{
+		return *created;
+	}
+
+	//another thread got there first
+	delete created;
+	return *res;
+}
+
+std::u8string_view Mapped_table::u8path(uint32_t const p_index) const
+{
+#ifdef _WIN32
+	std::atomic<std::u8string const*>& slot = m_u8paths[p_index];
+	std::u8string const* res = slot.load(std::memory_order_acquire);
+	if(res)
+	{
+		return *res;
+	}
+
+	std::u8string const* const created = new std::u8string{path(p_index).u8string()};
+	if(slot.compare_exchange_strong(res, created, std::memory_order_acq_rel, std::memory_order_acquire))
+	{
+		return *created;
+	}
+
+	//another thread got there first
+	delete created;
+	return *res;
+#else
+	core::os_string_view const native = m_image.path(p_index);
+	return std::u8string_view{reinterpret_cast<char8_t const*>(native.data()), native.size()};
+#endif
+}
+
+std::filesystem::path cache_file_name(std::filesystem::path const& p_file)
+{
+	std::filesystem::path res = p_file;
+	res += ".pfcache";
+	return res;
+}
+
+bool cache_directory_failed(std::filesystem::path const& p_cacheFile)
+{
+	std::lock_guard const lock{g_failedMutex};
+	return !g_failedDirectories.empty() && g_failedDirectories.contains(p_cacheFile.parent_path().native());
+}
+
+bool mark_cache_directory_failed(std::filesystem::path const& p_cacheFile)
+{
+	std::lock_guard const lock{g_failedMutex};
+	return g_failedDirectories.insert(p_cacheFile.parent_path().native()).second;
+}
+
+bool read_file(std::filesystem::path const& p_file, std::vector<std::byte>& p_out)
+{
+	std::ifstream file{p_file, std::ios::binary | std::ios::ate};
+	if(!file.is_open())
+	{
+		return false;
+	}
+
+	std::streamoff const size = file.tellg();
+	if(size < 0)
+	{
+		return false;
+	}
+
+	p_out.resize(static_cast<uintptr_t>(size));
+	file.seekg(0);
+	return file.read(reinterpret_cast<char*>(p_out.data()), size).good();
+}
+
+bool cache_source_info(std::filesystem::path const& p_file, bool const p_hashContent, cache_source_t& p_source)
+{
+	std::error_code ec;
+	std::filesystem::file_time_type const mtime = std::filesystem::last_write_time(p_file, ec);
+	if(ec != std::error_code{})
+	{
+		return false;
+	}
+
+	p_source.mtime        = static_cast<int64_t>(mtime.time_since_epoch().count());
+	p_source.path_hash    = hash_bytes(as_bytes(core::os_string_view{p_file.native()}));
+	p_source.content_hash = 0;
+
+	if(!p_hashContent)
+	{
+		p_source.size = std::filesystem::file_size(p_file, ec);
+		return ec == std::error_code{};
+	}
+
+	std::vector<std::byte> content;
+	if(!read_file(p_file, content))
+	{
+		return false;
+	}
+
+	p_source.size = content.size();
+	//0 is reserved for "not hashed"
+	p_source.content_hash = std::max<uint64_t>(hash_bytes(content), 1);
+	return true;
+}
+
+uint64_t environment_fingerprint(std::span<core::os_string_view const> const p_names, Environment const& p_environment)
+{
+	uint64_t res = hash_mix(0xCBF29CE484222325, p_names.size());
+	for(core::os_string_view const name : p_names)
+	{
+		res = hash_mix(res, hash_bytes(as_bytes(name)));
+
+		std::optional<core::os_string_view> const value = p_environment.get(name);
+		if(value.has_value())
+		{
+			res = hash_mix(res, hash_bytes(as_bytes(value.value())));
+		}
+		else
+		{
+			res = hash_mix(res, 0);
+		}
+	}
+	return res;
+}
+
+bool read_cache(std::filesystem::path const& p_cacheFile, cache_source_t const& p_source, Environment const& p_environment, PathTable::entries_t& p_entries)
+{
+	std::vector<std::byte> buffer;
+	if(!read_file(p_cacheFile, buffer))
+	{
+		return false;
+	}
+
+	Cache_image image;
+	if(!image.open(buffer) || !image.up_to_date(p_source, p_environment))
+	{
+		return false;
+	}
+
+	p_entries = image.to_entries();
+	return true;
+}
+
+bool write_cache(std::filesystem::path const& p_cacheFile, cache_source_t const& p_source,
+	Environment const& p_environment, std::span<core::os_string_view const> const p_envNames, std::span<PathTable::entry_ptr const> const p_entries)
+{
+	using header_t = Cache_image::header_t;
+	using env_t    = Cache_image::env_t;
+	using slot_t   = Cache_image::slot_t;
+	using entry_t  = Cache_image::entry_t;
+
+	uint32_t const entry_count = static_cast<uint32_t>(p_entries.size());
+	uint32_t const slot_count  = static_cast<uint32_t>(std::bit_ceil(std::max<uint64_t>(p_entries.size() * 2, 8)));
+
+	uint64_t const env_offset     = sizeof(header_t);
+	uint64_t const slots_offset   = env_offset     + p_envNames.size() * sizeof(env_t);
+	uint64_t const entries_offset = slots_offset   + slot_count  * uint64_t{sizeof(slot_t)};
+	uint64_t const native_offset  = entries_offset + entry_count * uint64_t{sizeof(entry_t)};
+
+	uint64_t native_size = 0;
+	uint64_t key_size = 0;
+	for(core::os_string_view const name : p_envNames)
+	{
+		native_size += (name.size() + 1) * sizeof(core::os_char);
+	}
+	for(PathTable::entry_ptr const& entry : p_entries)
+	{
+		native_size += (entry->native.size() + 1) * sizeof(core::os_char);
+		key_size    += entry->key.size();
+	}
+
+	uint64_t const key_offset = align8(native_offset + native_size);
+	uint64_t const total_size = align8(key_offset + key_size);
+
+	std::vector<std::byte> image(total_size);
+	std::byte* const base = image.data();
+
+	header_t& header = *reinterpret_cast<header_t*>(base);
+	memcpy(header.magic, cache_magic, sizeof(cache_magic));
+	header.version          = Cache_image::version;
+	header.os_char_size     = sizeof(core::os_char);
+	header.source_size      = p_source.size;
+	header.source_mtime     = p_source.mtime;
+	header.source_hash      = p_source.content_hash;
+	header.source_path_hash = p_source.path_hash;
+	header.env_fingerprint  = environment_fingerprint(p_envNames, p_environment);
+	header.env_count        = static_cast<uint32_t>(p_envNames.size());
+	header.slot_count       = slot_count;
+	header.entry_count      = entry_count;
+	header.reserved         = 0;
+	header.total_size       = total_size;
+
+	uint64_t native_pos = native_offset;
+	uint64_t key_pos    = key_offset;
+
+	env_t* const env = reinterpret_cast<env_t*>(base + env_offset);
+	for(uintptr_t i = 0; i < p_envNames.size(); ++i)
+	{
+		core::os_string_view const name = p_envNames[i];
+		env[i] = env_t{.name_offset = native_pos, .name_size = name.size()};
+		memcpy(base + native_pos, name.data(), name.size() * sizeof(core::os_char));
+		native_pos += (name.size() + 1) * sizeof(core::os_char);
+	}
+
+	std::span<std::byte const> const image_bytes{image};
+	header.header_hash = hash_mix(
+		hash_bytes(image_bytes.subspan(0, offsetof(header_t, header_hash))),
+		hash_bytes(image_bytes.subspan(env_offset, slots_offset - env_offset)));
+
+	entry_t* const entries = reinterpret_cast<entry_t*>(base + entries_offset);
+	for(uint32_t i = 0; i < entry_count; ++i)
+	{
+		PathTable::entry_t const& entry = *p_entries[i];
+		core::os_string_view const native = entry.native;
+
+		entries[i] = entry_t{
+			.hash        = entry.hash,
+			.value_hash  = entry.value_hash,
+			.path_offset = native_pos,
+			.key_offset  = key_pos,
+			.path_size   = static_cast<uint32_t>(native.size()),
+			.key_size    = static_cast<uint32_t>(entry.key.size()),
+			.flags       = entry.env_dependent ? Cache_image::flag_env_dependent : 0,
+			.reserved    = 0};
+
+		memcpy(base + native_pos, native.data(), native.size() * sizeof(core::os_char));
+		memcpy(base + key_pos, entry.key.data(), entry.key.size());
+		native_pos += (native.size() + 1) * sizeof(core::os_char);
+		key_pos    += entry.key.size();
+	}
+
+	//same probing scheme as PathTable
+	slot_t* const slots = reinterpret_cast<slot_t*>(base + slots_offset);
+	uint64_t const mask = slot_count - 1;
+	std::fill_n(slots, slot_count, slot_t{.tag = 0, .index = PathTable::npos});
+	for(uint32_t i = 0; i < entry_count; ++i)
+	{
+		uint64_t pos = entries[i].hash & mask;
+		while(slots[pos].index != PathTable::npos)
+		{
+			pos = (pos + 1) & mask;
+		}
+		slots[pos] = slot_t{.tag = static_cast<uint32_t>(entries[i].hash >> 32), .index = i};
+	}
+
+	//write to a unique temporary and rename over the cache, so that concurrent loaders never see a partial file
+	std::filesystem::path tmp_name = p_cacheFile;
+	tmp_name += ".";
+	tmp_name += std::to_string(std::random_device{}());
+
+	{
+		std::ofstream file{tmp_name, std::ios::binary | std::ios::trunc};
+		if(!file.is_open())
+		{
+			return false;
+		}
+		if(!file.write(reinterpret_cast<char const*>(base), static_cast<std::streamsize>(total_size)).good())
+		{
+			file.close();
+			std::error_code ec;
+			std::filesystem::remove(tmp_name, ec);
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tmp_name, p_cacheFile, ec);
+#ifdef _WIN32
+	if(ec != std::error_code{})
+	{
+		//a cache that is still mapped, by this process or another, can not be replaced but it can be renamed.
+		//It is moved out of the way, and deleted by a later write once nothing maps it anymore
+		std::filesystem::path stale_name = tmp_name;
+		stale_name += ".stale";
+		std::error_code moved;
+		std::filesystem::rename(p_cacheFile, stale_name, moved);
+		if(moved == std::error_code{})
+		{
+			ec.clear();
+			std::filesystem::rename(tmp_name, p_cacheFile, ec);
+		}
+	}
+	remove_stale_caches(p_cacheFile);
+#endif
+	if(ec != std::error_code{})
+	{
+		std::filesystem::remove(tmp_name, ec);
+		return false;
+	}
+	return true;
+}
+
+} //namespace pathfinder
@@ -0,0 +1,199 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <CoreLib/string/core_os_string.hpp>
+
+#include <pathfinderLib/pathfinder_environment.hpp>
+#include <pathfinderLib/pathfinder_table.hpp>
+
+#include "file_mapping.hpp"
+
+namespace pathfinder
+{
+	///	\brief Identity of the source file a cache was compiled from
+	struct cache_source_t
+	{
+		uint64_t size;
+		int64_t  mtime;
+		uint64_t content_hash; //!< 0 if the content was not hashed
+		uint64_t path_hash;
+	};
+
+	///	\brief Read-only view over a compiled path table image.
+	///	\note The image layout is:
+	///		header_t | env_t[env_count] | slot_t[slot_count] | entry_t[entry_count] | native strings | key strings
+	///		Offsets are relative to the start of the image. Native strings are null terminated.
+	class Cache_image
+	{
+	public:
+		struct header_t
+		{
+			char     magic[8];
+			uint32_t version;
+			uint32_t os_char_size;
+			uint64_t source_size;
+			int64_t  source_mtime;
+			uint64_t source_hash;
+			uint64_t source_path_hash;
+			uint64_t env_fingerprint;
+			uint32_t env_count;
+			uint32_t slot_count;
+			uint32_t entry_count;
+			uint32_t reserved;
+			uint64_t total_size;
+			uint64_t header_hash; //!< of the header up to this field and of the env_t array
+		};
+
+		struct env_t
+		{
+			uint64_t name_offset;
+			uint64_t name_size;
+		};
+
+		struct slot_t
+		{
+			uint32_t tag;
+			uint32_t index;
+		};
+
+		struct entry_t
+		{
+			uint64_t hash;
+			uint64_t value_hash; //!< see PathTable::entry_t::value_hash
+			uint64_t path_offset;
+			uint64_t key_offset;
+			uint32_t path_size;
+			uint32_t key_size;
+			uint32_t flags;
+			uint32_t reserved;
+		};
+
+		///	\brief Bits of entry_t::flags
+		static constexpr uint32_t flag_env_dependent = 0x01;
+
+		static constexpr uint32_t version = 3;
+
+	public:
+		///	\brief Checks the header, the bounds of each section and the environment table of \p p_image.
+		///	\note Slots and entries are not read up front, so that only the pages of the entries used are touched,
+		///		they are checked when they are accessed instead. A corrupted entry reads as an empty key and path.
+		bool open(std::span<std::byte const> p_image);
+
+		///	\brief Checks that the image was compiled from \p p_source under \p p_environment.
+		///	\note The content hash is only compared if \p p_source has one, an image written without one never matches it.
+		bool up_to_date(cache_source_t const& p_source, Environment const& p_environment) const;
+
+		uint32_t find(std::u8string_view p_key, uint64_t p_hash) const;
+
+		inline uint32_t size() const { return m_header->entry_count; }
+		inline uintptr_t image_size() const { return m_image.size(); }
+		inline uint64_t hash(uint32_t const p_index) const { return m_entries[p_index].hash; }
+		inline uint64_t value_hash(uint32_t const p_index) const { return m_entries[p_index].value_hash; }
+		inline bool env_dependent(uint32_t const p_index) const { return m_entries[p_index].flags & flag_env_dependent; }
+		std::u8string_view  key (uint32_t p_index) const;
+		core::os_string_view path(uint32_t p_index) const;
+
+		///	\brief Copies every entry out of the image, sorted by key
+		///	\note Corrupted entries are skipped, as well as repeated keys.
+		PathTable::entries_t to_entries() const;
+
+	private:
+		std::span<std::byte const> m_image;
+		header_t const* m_header  = nullptr;
+		env_t    const* m_env     = nullptr;
+		slot_t   const* m_slots   = nullptr;
+		entry_t  const* m_entries = nullptr;
+	};
+
+	///	\brief Path table served straight out of a mapped cache file.
+	///	\note Only views are handed out by default, std::filesystem::path objects are materialized on first request.
+	class Mapped_table
+	{
+	public:
+		Mapped_table() = default;
+		~Mapped_table();
+
+		bool open(std::filesystem::path const& p_cacheFile, cache_source_t const& p_source, Environment const& p_environment);
+
+		inline Cache_image const& image() const { return m_image; }
+		std::filesystem::path const& path(uint32_t p_index) const;
+
+		///	\brief UTF-8 form of the path, null terminated.
+		///	\note Outside of Windows this is a view of the image, on Windows it is converted on first request.
+		std::u8string_view u8path(uint32_t p_index) const;
+
+	private:
+		File_mapping m_mapping;
+		Cache_image  m_image;
+		std::unique_ptr<std::atomic<std::filesystem::path const*>[]> m_paths;
+#ifdef _WIN32
+		std::unique_ptr<std::atomic<std::u8string const*>[]> m_u8paths;
+#endif
+	};
+
+	///	\brief Name of the compiled cache for a given source file
+	std::filesystem::path cache_file_name(std::filesystem::path const& p_file);
+
+	///	\brief Reads the identity of \p p_file
+	///	\param[in] p_hashContent - Whether to read and hash the whole file, otherwise only its size and modification time are checked
+	bool cache_source_info(std::filesystem::path const& p_file, bool p_hashContent, cache_source_t& p_source);
+
+	///	\brief Hash of the values the given environment variables have in \p p_environment
+	uint64_t environment_fingerprint(std::span<core::os_string_view const> p_names, Environment const& p_environment);
+
+	///	\brief Reads \p p_file in one go
+	bool read_file(std::filesystem::path const& p_file, std::vector<std::byte>& p_out);
+
+	///	\brief Reads the cache entries if the cache exists and is up to date.
+	///	\param[out] p_entries - Entries sorted by key
+	bool read_cache(std::filesystem::path const& p_cacheFile, cache_source_t const& p_source, Environment const& p_environment, PathTable::entries_t& p_entries);
+
+	///	\brief Whether a cache could not be written into the directory of \p p_cacheFile before, in this process.
+	bool cache_directory_failed(std::filesystem::path const& p_cacheFile);
+
+	///	\brief Remembers for the rest of the process that a cache could not be written into the directory of \p p_cacheFile.
+	///	\return false if it was already known.
+	bool mark_cache_directory_failed(std::filesystem::path const& p_cacheFile);
+
+	///	\brief Compiles \p p_entries into \p p_cacheFile, replacing it atomically.
+	///	\param[in] p_entries - Entries sorted by key
+	bool write_cache(std::filesystem::path const& p_cacheFile, cache_source_t const& p_source,
+		Environment const& p_environment, std::span<core::os_string_view const> p_envNames, std::span<PathTable::entry_ptr const> p_entries);
+
+} //namespace pathfinder
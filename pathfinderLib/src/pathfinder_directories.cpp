@@ -0,0 +1,109 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include <pathfinderLib/pathfinder_directories.hpp>
+
+#ifdef __linux__
+#	include <fcntl.h>
+#	include <unistd.h>
+#endif
+
+namespace pathfinder
+{
+
+Directory_handles::~Directory_handles()
+{
+	reset();
+}
+
+int Directory_handles::open([[maybe_unused]] uint32_t const p_index, [[maybe_unused]] uint32_t const p_count, [[maybe_unused]] std::filesystem::path::value_type const* const p_path) const
+{
+#ifdef __linux__
+	handles_t* handles = m_handles.load(std::memory_order_acquire);
+	if(handles == nullptr)
+	{
+		handles_t* const created = new handles_t{.count = p_count, .fds = std::make_unique<std::atomic<int>[]>(p_count)};
+		if(m_handles.compare_exchange_strong(handles, created, std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			handles = created;
+		}
+		else
+		{
+			//another thread got there first
+			delete created;
+		}
+	}
+
+	std::atomic<int>& slot = handles->fds[p_index];
+	int const cached = slot.load(std::memory_order_acquire);
+	if(cached)
+	{
+		return cached - 1;
+	}
+
+	//failures are not remembered, the directory may be created later
+	int const fd = ::open(p_path, O_PATH | O_DIRECTORY | O_CLOEXEC);
+	if(fd < 0)
+	{
+		return -1;
+	}
+
+	int expected = 0;
+	if(slot.compare_exchange_strong(expected, fd + 1, std::memory_order_acq_rel, std::memory_order_acquire))
+	{
+		return fd;
+	}
+
+	::close(fd);
+	return expected - 1;
+#else
+	return -1;
+#endif
+}
+
+void Directory_handles::reset()
+{
+	handles_t* const handles = m_handles.exchange(nullptr, std::memory_order_acq_rel);
+	if(handles == nullptr)
+	{
+		return;
+	}
+
+#ifdef __linux__
+	for(uint32_t i = 0; i < handles->count; ++i)
+	{
+		int const fd = handles->fds[i].load(std::memory_order_relaxed);
+		if(fd)
+		{
+			::close(fd - 1);
+		}
+	}
+#endif
+	delete handles;
+}
+
+} //namespace pathfinder
@@ -0,0 +1,137 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include <pathfinderLib/pathfinder_environment.hpp>
+
+#ifdef _WIN32
+#	define WIN32_LEAN_AND_MEAN
+#	include <Windows.h>
+#else
+extern char** environ;
+#endif
+
+namespace pathfinder
+{
+
+#ifdef _WIN32
+
+bool Environment::name_less::operator () (core::os_string_view const p_1, core::os_string_view const p_2) const
+{
+	return CompareStringOrdinal(p_1.data(), static_cast<int>(p_1.size()), p_2.data(), static_cast<int>(p_2.size()), TRUE) == CSTR_LESS_THAN;
+}
+
+Environment Environment::capture()
+{
+	Environment res;
+
+	wchar_t* const block = GetEnvironmentStringsW();
+	if(block == nullptr)
+	{
+		return res;
+	}
+
+	//block is a sequence of null terminated "name=value" strings, terminated by an empty string
+	for(wchar_t const* it = block; *it; )
+	{
+		std::wstring_view const variable{it};
+		it += variable.size() + 1;
+
+		//entries such as "=C:=C:\dir" keep the per drive current directory, they are not variables
+		if(variable.front() == L'=')
+		{
+			continue;
+		}
+
+		uintptr_t const pos = variable.find(L'=');
+		if(pos == std::wstring_view::npos)
+		{
+			continue;
+		}
+		res.m_variables.emplace(variable.substr(0, pos), variable.substr(pos + 1));
+	}
+
+	FreeEnvironmentStringsW(block);
+	return res;
+}
+
+#else
+
+bool Environment::name_less::operator () (core::os_string_view const p_1, core::os_string_view const p_2) const
+{
+	return p_1 < p_2;
+}
+
+Environment Environment::capture()
+{
+	Environment res;
+
+	if(environ == nullptr)
+	{
+		return res;
+	}
+
+	for(char const* const* it = environ; *it; ++it)
+	{
+		std::string_view const variable{*it};
+		uintptr_t const pos = variable.find('=');
+		if(pos == std::string_view::npos)
+		{
+			continue;
+		}
+		res.m_variables.emplace(variable.substr(0, pos), variable.substr(pos + 1));
+	}
+
+	return res;
+}
+
+#endif
+
+std::optional<core::os_string_view> Environment::get(core::os_string_view const p_name) const
+{
+	variables_t::const_iterator const it = m_variables.find(p_name);
+	if(it == m_variables.end())
+	{
+		return std::nullopt;
+	}
+	return core::os_string_view{it->second};
+}
+
+void Environment::set(core::os_string p_name, core::os_string p_value)
+{
+	m_variables.insert_or_assign(std::move(p_name), std::move(p_value));
+}
+
+void Environment::erase(core::os_string_view const p_name)
+{
+	variables_t::const_iterator const it = m_variables.find(p_name);
+	if(it != m_variables.end())
+	{
+		m_variables.erase(it);
+	}
+}
+
+} //namespace pathfinder
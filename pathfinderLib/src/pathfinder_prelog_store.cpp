@@ -27,15 +27,160 @@
 
 #include <pathfinderLib/pathfinder_prelog_store.hpp>
 
+#include <algorithm>
+#include <cstring>
+#include <new>
+
 namespace pathfinder
 {
 
-Log_store::Log_store() = default;
+struct alignas(std::max_align_t) Log_store::chunk_t
+{
+	chunk_t*               previous;
+	uintptr_t              capacity;
+	std::atomic<uintptr_t> used;
+
+	inline std::byte* data() { return reinterpret_cast<std::byte*>(this + 1); }
+};
+
+namespace
+{
+	static constexpr uintptr_t chunk_size = 16 * 1024;
+	static constexpr uintptr_t arena_alignment = alignof(std::max_align_t);
+
+	static constexpr uintptr_t align_up(uintptr_t const p_size)
+	{
+		return (p_size + (arena_alignment - 1)) & ~(arena_alignment - 1);
+	}
+} //namespace
+
+Log_store::Log_store()
+	: m_tail{&m_stub}
+	, m_head{&m_stub}
+	, m_stub{.next = nullptr, .file = nullptr, .line = 0, .column = 0, .level = logger::Level::Debug, .size = 0}
+{
+}
+
+Log_store::~Log_store()
+{
+	clear();
+}
+
+void* Log_store::allocate(uintptr_t const p_size)
+{
+	static_assert(sizeof(chunk_t) % arena_alignment == 0);
+	uintptr_t const size = align_up(p_size);
+
+	chunk_t* chunk = m_chunk.load(std::memory_order_acquire);
+	while(true)
+	{
+		if(chunk)
+		{
+			uintptr_t const offset = chunk->used.fetch_add(size, std::memory_order_relaxed);
+			if(offset + size <= chunk->capacity)
+			{
+				return chunk->data() + offset;
+			}
+		}
+
+		//chunk is full, whoever installs the next one first wins and the others retry from it
+		uintptr_t const capacity = std::max(chunk_size, size);
+		chunk_t* const fresh = new (::operator new(sizeof(chunk_t) + capacity)) chunk_t{.previous = chunk, .capacity = capacity, .used = size};
+		if(m_chunk.compare_exchange_strong(chunk, fresh, std::memory_order_acq_rel, std::memory_order_acquire))
+		{
+			return fresh->data();
+		}
+		fresh->~chunk_t();
+		::operator delete(fresh);
+	}
+}
+
+Log_store::file_t const* Log_store::intern(core::os_string_view const p_file)
+{
+	file_t const* const head = m_files.load(std::memory_order_acquire);
+	for(file_t const* file = head; file; file = file->next)
+	{
+		if(file->name() == p_file)
+		{
+			return file;
+		}
+	}
+
+	file_t* const created = new (allocate(sizeof(file_t) + p_file.size() * sizeof(core::os_char))) file_t{.next = head, .size = p_file.size()};
+	std::memcpy(const_cast<core::os_char*>(created->name().data()), p_file.data(), p_file.size() * sizeof(core::os_char));
+
+	//only the names added since the last look need to be checked again
+	file_t const* expected = head;
+	while(!m_files.compare_exchange_weak(expected, created, std::memory_order_acq_rel, std::memory_order_acquire))
+	{
+		for(file_t const* file = expected; file != created->next; file = file->next)
+		{
+			if(file->name() == p_file)
+			{
+				//the arena space is simply left unused
+				return file;
+			}
+		}
+		created->next = expected;
+	}
+	return created;
+}
 
 void Log_store::push2log(core::os_string_view const p_file, uint32_t const p_line, uint32_t const p_column, logger::Level const p_level, std::u8string_view const p_message)
 {
-	m_data.emplace(p_file, p_line, p_column, p_level, p_message);
+	file_t const* const file = intern(p_file);
+
+	node_t* const node = new (allocate(sizeof(node_t) + p_message.size())) node_t{
+		.next   = nullptr,
+		.file   = file,
+		.line   = p_line,
+		.column = p_column,
+		.level  = p_level,
+		.size   = p_message.size()};
+	std::memcpy(const_cast<char8_t*>(node->message().data()), p_message.data(), p_message.size());
+
+	node_t* const previous = m_tail.exchange(node, std::memory_order_acq_rel);
+	previous->next.store(node, std::memory_order_release);
+}
+
+void Log_store::replay(Log_proxy& p_target)
+{
+	drain(
+		[&p_target](record_t const& p_record)
+		{
+			if(p_target.accept(p_record.level))
+			{
+				p_target.push2log(p_record.file, p_record.line, p_record.column, p_record.level, p_record.message);
+			}
+		});
+}
+
+std::queue<Log_store::data_t> Log_store::take_data()
+{
+	std::queue<data_t> res;
+	drain(
+		[&res](record_t const& p_record)
+		{
+			res.emplace(p_record.file, p_record.line, p_record.column, p_record.level, p_record.message);
+		});
+	return res;
 }
 
+void Log_store::clear()
+{
+	chunk_t* chunk = m_chunk.exchange(nullptr, std::memory_order_acquire);
+	while(chunk)
+	{
+		chunk_t* const previous = chunk->previous;
+		chunk->~chunk_t();
+		::operator delete(chunk);
+		chunk = previous;
+	}
+
+	m_files.store(nullptr, std::memory_order_relaxed);
+	m_stub.next.store(nullptr, std::memory_order_relaxed);
+	m_tail.store(&m_stub, std::memory_order_relaxed);
+	m_head = &m_stub;
 }
 
+} //namespace pathfinder
@@ -0,0 +1,204 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include <pathfinderLib/pathfinder_publisher.hpp>
+
+#include <algorithm>
+
+namespace pathfinder
+{
+namespace
+{
+	///	\brief Per thread reader state.
+	///	\note Records are never freed, once a thread exits its record is up for grabs by the next new reader.
+	struct reader_record
+	{
+		///	\brief Snapshots the thread may still be using, in the order they were acquired, nullptr if none
+		std::atomic<PathFinder const*> hazards[PathFinder_publisher::protected_snapshots] = {};
+		std::atomic<bool>              in_use = true;
+		reader_record*                 next   = nullptr;
+		uint32_t                       latest = 0; //!< slot of the snapshot acquired last, only used by the owning thread
+
+		inline void release()
+		{
+			for(std::atomic<PathFinder const*>& hazard : hazards)
+			{
+				hazard.store(nullptr, std::memory_order_release);
+			}
+		}
+	};
+
+	static std::atomic<reader_record*> g_readers = nullptr;
+
+	static reader_record* claim_record()
+	{
+		for(reader_record* it = g_readers.load(std::memory_order_acquire); it; it = it->next)
+		{
+			bool expected = false;
+			if(!it->in_use.load(std::memory_order_relaxed) &&
+				it->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire))
+			{
+				return it;
+			}
+		}
+
+		reader_record* const record = new reader_record;
+		record->next = g_readers.load(std::memory_order_relaxed);
+		while(!g_readers.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed));
+		return record;
+	}
+
+	class thread_reader
+	{
+	public:
+		thread_reader(): m_record{claim_record()} {}
+		~thread_reader()
+		{
+			m_record->release();
+			m_record->in_use.store(false, std::memory_order_release);
+		}
+
+		inline reader_record& record() { return *m_record; }
+
+	private:
+		reader_record* const m_record;
+	};
+
+	static reader_record& local_record()
+	{
+		thread_local thread_reader t_reader;
+		return t_reader.record();
+	}
+
+	///	\return Whether a reader may still be using \p p_snapshot
+	static bool in_use(PathFinder const* const p_snapshot)
+	{
+		for(reader_record* it = g_readers.load(std::memory_order_acquire); it; it = it->next)
+		{
+			for(std::atomic<PathFinder const*> const& hazard : it->hazards)
+			{
+				if(hazard.load(std::memory_order_seq_cst) == p_snapshot)
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+} //namespace
+
+PathFinder_publisher::PathFinder_publisher() = default;
+
+PathFinder_publisher::~PathFinder_publisher()
+{
+	//at this point no reader should be left, anything else would be a use after free regardless
+	delete m_current.exchange(nullptr, std::memory_order_acquire);
+}
+
+PathFinder const* PathFinder_publisher::acquire()
+{
+	reader_record& record = local_record();
+	PathFinder const* current = m_current.load(std::memory_order_seq_cst);
+
+	//the snapshot was protected before and still is, it can not have been freed and its address reused in between,
+	//and there is nothing to protect while nothing is published
+	if(current == record.hazards[record.latest].load(std::memory_order_relaxed) || current == nullptr)
+	{
+		return current;
+	}
+
+	//the oldest snapshot is let go of to protect the new one
+	uint32_t const slot = (record.latest + 1) % protected_snapshots;
+	std::atomic<PathFinder const*>& hazard = record.hazards[slot];
+	PathFinder const* const evicted = hazard.load(std::memory_order_relaxed);
+
+	//the hazard must be visible before the snapshot is confirmed to still be current,
+	//otherwise a writer could miss it and free the snapshot under us
+	PathFinder const* protect;
+	do
+	{
+		protect = current;
+		hazard.store(protect, std::memory_order_seq_cst);
+		current = m_current.load(std::memory_order_seq_cst);
+	}
+	while(current != protect);
+	record.latest = slot;
+
+	//the snapshot let go of may have been waiting on this thread to be freed
+	if(evicted && m_retiredCount.load(std::memory_order_relaxed))
+	{
+		std::unique_lock lock{m_retiredMutex, std::try_to_lock};
+		if(lock.owns_lock())
+		{
+			reclaim_locked();
+		}
+	}
+	return current;
+}
+
+void PathFinder_publisher::quiescent()
+{
+	local_record().release();
+}
+
+void PathFinder_publisher::publish(std::unique_ptr<PathFinder> p_next)
+{
+	if(p_next)
+	{
+		p_next->m_generation = m_generation.load(std::memory_order_relaxed) + 1;
+	}
+
+	PathFinder const* const old = m_current.exchange(p_next.release(), std::memory_order_seq_cst);
+	m_generation.fetch_add(1, std::memory_order_acq_rel);
+
+	std::lock_guard const lock{m_retiredMutex};
+	if(old)
+	{
+		m_retired.emplace_back(old);
+		m_retiredCount.store(m_retired.size(), std::memory_order_relaxed);
+	}
+	reclaim_locked();
+}
+
+void PathFinder_publisher::reclaim()
+{
+	std::lock_guard const lock{m_retiredMutex};
+	reclaim_locked();
+}
+
+void PathFinder_publisher::reclaim_locked()
+{
+	if(m_retired.empty())
+	{
+		return;
+	}
+
+	std::erase_if(m_retired, [](std::unique_ptr<PathFinder const> const& p_retired) { return !in_use(p_retired.get()); });
+	m_retiredCount.store(m_retired.size(), std::memory_order_relaxed);
+}
+
+} //namespace pathfinder
@@ -0,0 +1,352 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include <pathfinderLib/pathfinder_table.hpp>
+
+#include <algorithm>
+#include <bit>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#	include <xmmintrin.h>
+#endif
+
+namespace pathfinder
+{
+namespace
+{
+	///	\brief First block of an Entry_arena, the following ones grow geometrically
+	static constexpr uintptr_t arena_block_size = 16 * 1024;
+
+	///	\brief Allocates from the resource of an Entry_arena and keeps it alive.
+	///	\note Every entry holds a copy in its control block, so that the key and path stored with it live as long as it does.
+	///		Memory is only given back once the whole block is released, deallocating is a no-op and may happen from any thread.
+	template<typename T>
+	class arena_allocator
+	{
+	public:
+		using value_type = T;
+
+		inline explicit arena_allocator(std::shared_ptr<std::pmr::monotonic_buffer_resource> p_resource): m_resource{std::move(p_resource)} {}
+
+		template<typename U>
+		inline arena_allocator(arena_allocator<U> const& p_other): m_resource{p_other.resource()} {}
+
+		inline T* allocate(std::size_t const p_count) { return static_cast<T*>(m_resource->allocate(p_count * sizeof(T), alignof(T))); }
+		inline void deallocate(T*, std::size_t) {}
+
+		inline std::shared_ptr<std::pmr::monotonic_buffer_resource> const& resource() const { return m_resource; }
+
+		template<typename U>
+		inline bool operator == (arena_allocator<U> const& p_other) const { return m_resource == p_other.resource(); }
+
+	private:
+		std::shared_ptr<std::pmr::monotonic_buffer_resource> m_resource;
+	};
+
+	static inline void prefetch(void const* const p_address)
+	{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+		_mm_prefetch(static_cast<char const*>(p_address), _MM_HINT_T0);
+#elif defined(__GNUC__)
+		__builtin_prefetch(p_address);
+#else
+		static_cast<void>(p_address);
+#endif
+	}
+} //namespace
+
+void PathTable::freeze(entries_t&& p_staging)
+{
+	if(p_staging.empty())
+	{
+		return;
+	}
+
+	if(m_entries.empty())
+	{
+		m_entries = std::move(p_staging);
+		build_slots();
+		return;
+	}
+
+	entries_t merged;
+	merged.reserve(m_entries.size() + p_staging.size());
+
+	//both sources are sorted by key, merge them so that the entries stay sorted
+	entries_t::iterator old_it = m_entries.begin();
+	entries_t::iterator const old_end = m_entries.end();
+
+	for(entry_ptr& entry : p_staging)
+	{
+		while(old_it != old_end && (*old_it)->key < entry->key)
+		{
+			merged.push_back(std::move(*old_it));
+			++old_it;
+		}
+
+		if(old_it != old_end && (*old_it)->key == entry->key)
+		{
+			continue;
+		}
+
+		merged.push_back(std::move(entry));
+	}
+
+	for(; old_it != old_end; ++old_it)
+	{
+		merged.push_back(std::move(*old_it));
+	}
+
+	m_entries = std::move(merged);
+	build_slots();
+}
+
+PathTable::entry_t::~entry_t()
+{
+	delete m_path.load(std::memory_order_relaxed);
+#ifdef _WIN32
+	delete m_u8path.load(std::memory_order_relaxed);
+#endif
+}
+
+std::filesystem::path const& PathTable::entry_t::resolved_path() const
+{
+	if(lazy)
+	{
+		std::call_once(lazy->once,
+			[this]()
+			{
+				if(!lazy->source->resolve(*this, lazy->path))
+				{
+					lazy->path.clear();
+				}
+			});
+		return lazy->path;
+	}
+
+	std::filesystem::path const* res = m_path.load(std::memory_order_acquire);
+	if(res)
+	{
+		return *res;
+	}
+
+	std::filesystem::path const* const created = new std::filesystem::path{native};
+	if(m_path.compare_exchange_strong(res, created, std::memory_order_acq_rel, std::memory_order_acquire))
+	{
+		return *created;
+	}
+
+	//another thread got there first
+	delete created;
+	return *res;
+}
+
+core::os_string_view PathTable::entry_t::resolved_native() const
+{
+	return lazy ? core::os_string_view{resolved_path().native()} : native;
+}
+
+std::u8string_view PathTable::entry_t::resolved_u8path() const
+{
+#ifdef _WIN32
+	std::u8string const* res = m_u8path.load(std::memory_order_acquire);
+	if(res)
+	{
+		return *res;
+	}
+
+	std::u8string const* const created = new std::u8string{resolved_path().u8string()};
+	if(m_u8path.compare_exchange_strong(res, created, std::memory_order_acq_rel, std::memory_order_acquire))
+	{
+		return *created;
+	}
+
+	//another thread got there first
+	delete created;
+	return *res;
+#else
+	core::os_string_view const res = resolved_native();
+	return std::u8string_view{reinterpret_cast<char8_t const*>(res.data()), res.size()};
+#endif
+}
+
+PathTable::Entry_arena::Entry_arena()
+	: m_resource{std::make_shared<std::pmr::monotonic_buffer_resource>(arena_block_size)}
+{
+}
+
+template<typename T>
+T* PathTable::Entry_arena::store(std::basic_string_view<T> const p_text)
+{
+	T* const res = static_cast<T*>(m_resource->allocate((p_text.size() + 1) * sizeof(T), alignof(T)));
+	std::copy(p_text.begin(), p_text.end(), res);
+	res[p_text.size()] = T{0};
+	return res;
+}
+
+std::shared_ptr<PathTable::entry_t> PathTable::Entry_arena::make(std::u8string_view const p_key, core::os_string_view const p_path)
+{
+	std::shared_ptr<entry_t> res = std::allocate_shared<entry_t>(arena_allocator<entry_t>{m_resource});
+	res->key    = std::u8string_view{store(p_key), p_key.size()};
+	res->native = p_path.empty() ? core::os_string_view{} : core::os_string_view{store(p_path), p_path.size()};
+	res->hash   = hash(p_key);
+	return res;
+}
+
+PathTable::entry_ptr PathTable::Entry_arena::make_entry(std::u8string_view const p_key, core::os_string_view const p_path, uint64_t const p_valueHash, bool const p_envDependent)
+{
+	std::shared_ptr<entry_t> res = make(p_key, p_path);
+	res->value_hash    = p_valueHash;
+	res->env_dependent = p_envDependent;
+	return res;
+}
+
+PathTable::entry_ptr PathTable::Entry_arena::make_lazy_entry(std::u8string_view const p_key, std::unique_ptr<lazy_t>&& p_lazy, uint64_t const p_valueHash, bool const p_envDependent)
+{
+	std::shared_ptr<entry_t> res = make(p_key, {});
+	res->value_hash    = p_valueHash;
+	res->env_dependent = p_envDependent;
+	res->lazy          = std::move(p_lazy);
+	return res;
+}
+
+uintptr_t PathTable::memory_usage() const
+{
+	uintptr_t res = m_entries.capacity() * sizeof(entry_ptr) + m_slots.capacity() * sizeof(slot_t);
+	for(entry_ptr const& entry : m_entries)
+	{
+		res += sizeof(entry_t) + entry->key.size() + 1;
+		//the path of a lazy entry may be being resolved by a reader, paths created on request are not counted either
+		if(entry->lazy)
+		{
+			res += sizeof(lazy_t) + entry->lazy->value.capacity() * sizeof(char32_t);
+		}
+		else
+		{
+			res += (entry->native.size() + 1) * sizeof(core::os_char);
+		}
+	}
+	return res;
+}
+
+void PathTable::clear()
+{
+	m_entries.clear();
+	m_slots.clear();
+	m_mask = 0;
+}
+
+void PathTable::share_unchanged(entries_t& p_entries) const
+{
+	for(entry_ptr& entry : p_entries)
+	{
+		uint32_t const index = find(entry->key, entry->hash);
+		if(index != npos && !m_entries[index]->lazy && !entry->lazy && m_entries[index]->native == entry->native)
+		{
+			entry = m_entries[index];
+		}
+	}
+}
+
+void PathTable::build_slots()
+{
+	//keep the load factor at or below 50% so that probe sequences stay within a cache line
+	uint64_t const capacity = std::bit_ceil(std::max<uint64_t>(m_entries.size() * 2, 8));
+
+	m_slots.assign(capacity, slot_t{.tag = 0, .index = npos});
+	m_mask = capacity - 1;
+
+	for(uint32_t i = 0, size = static_cast<uint32_t>(m_entries.size()); i < size; ++i)
+	{
+		uint64_t const t_hash = m_entries[i]->hash;
+		uint64_t pos = t_hash & m_mask;
+		while(m_slots[pos].index != npos)
+		{
+			pos = (pos + 1) & m_mask;
+		}
+		m_slots[pos] = slot_t{.tag = static_cast<uint32_t>(t_hash >> 32), .index = i};
+	}
+}
+
+uint32_t PathTable::find(std::u8string_view const p_key) const
+{
+	return find(p_key, hash(p_key));
+}
+
+uint32_t PathTable::find(std::u8string_view const p_key, uint64_t const p_hash) const
+{
+	if(m_slots.empty())
+	{
+		return npos;
+	}
+
+	uint32_t const tag = static_cast<uint32_t>(p_hash >> 32);
+	for(uint64_t pos = p_hash & m_mask; ; pos = (pos + 1) & m_mask)
+	{
+		slot_t const& slot = m_slots[pos];
+		if(slot.index == npos)
+		{
+			return npos;
+		}
+		if(slot.tag == tag && m_entries[slot.index]->key == p_key)
+		{
+			return slot.index;
+		}
+	}
+}
+
+void PathTable::find(std::span<std::u8string_view const> const p_keys, std::span<uint32_t> const p_out) const
+{
+	if(m_slots.empty())
+	{
+		std::fill_n(p_out.begin(), p_keys.size(), npos);
+		return;
+	}
+
+	//hash a batch and prefetch its slots before probing any of them,
+	//so that the cache misses of the batch are served in parallel
+	constexpr uintptr_t batch_size = 8;
+	uint64_t hashes[batch_size];
+
+	for(uintptr_t base = 0, size = p_keys.size(); base < size; base += batch_size)
+	{
+		uintptr_t const count = std::min(batch_size, size - base);
+
+		for(uintptr_t i = 0; i < count; ++i)
+		{
+			hashes[i] = hash(p_keys[base + i]);
+			prefetch(&m_slots[hashes[i] & m_mask]);
+		}
+
+		for(uintptr_t i = 0; i < count; ++i)
+		{
+			p_out[base + i] = find(p_keys[base + i], hashes[i]);
+		}
+	}
+}
+
+} //namespace pathfinder
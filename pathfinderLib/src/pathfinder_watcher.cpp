@@ -0,0 +1,292 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include <pathfinderLib/pathfinder_watcher.hpp>
+
+#ifdef __linux__
+#	include <poll.h>
+#	include <sys/eventfd.h>
+#	include <sys/inotify.h>
+#	include <unistd.h>
+#endif
+
+namespace pathfinder
+{
+namespace
+{
+	///	\brief Time given to an editor or deployment tool to finish writing before the file is reloaded
+	static constexpr std::chrono::milliseconds settle_time{100};
+} //namespace
+
+File_watcher::File_watcher() = default;
+
+File_watcher::~File_watcher()
+{
+	stop();
+}
+
+void File_watcher::start(callback_t p_callback, std::chrono::milliseconds const p_pollInterval)
+{
+	stop();
+
+	m_callback     = std::move(p_callback);
+	m_pollInterval = p_pollInterval;
+	m_stop.store(false, std::memory_order_relaxed);
+
+#ifdef __linux__
+	m_inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	m_wakeFd    = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+	if(m_inotifyFd >= 0 && m_wakeFd >= 0)
+	{
+		bool watching = true;
+		{
+			std::lock_guard const lock{m_mutex};
+			for(file_state_t& state : m_files)
+			{
+				watching = watching && add_inotify_watch(state);
+			}
+		}
+
+		if(watching)
+		{
+			m_thread = std::thread{&File_watcher::run_inotify, this};
+			return;
+		}
+	}
+
+	if(m_inotifyFd >= 0) close(m_inotifyFd);
+	if(m_wakeFd    >= 0) close(m_wakeFd);
+	m_inotifyFd = -1;
+	m_wakeFd    = -1;
+	m_watches.clear();
+#endif
+
+	m_thread = std::thread{&File_watcher::run_polling, this};
+}
+
+void File_watcher::stop()
+{
+	if(!m_thread.joinable())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard const lock{m_mutex};
+		m_stop.store(true, std::memory_order_relaxed);
+	}
+	m_stopCondition.notify_all();
+
+#ifdef __linux__
+	if(m_wakeFd >= 0)
+	{
+		uint64_t const value = 1;
+		[[maybe_unused]] ssize_t const res = write(m_wakeFd, &value, sizeof(value));
+	}
+#endif
+
+	m_thread.join();
+
+#ifdef __linux__
+	if(m_inotifyFd >= 0) close(m_inotifyFd);
+	if(m_wakeFd    >= 0) close(m_wakeFd);
+	m_inotifyFd = -1;
+	m_wakeFd    = -1;
+	m_watches.clear();
+#endif
+}
+
+void File_watcher::add(std::filesystem::path const& p_file)
+{
+	std::error_code ec;
+	file_state_t state{.file = p_file, .mtime = std::filesystem::last_write_time(p_file, ec), .size = 0};
+	state.size = std::filesystem::file_size(p_file, ec);
+
+	std::lock_guard const lock{m_mutex};
+	for(file_state_t const& it : m_files)
+	{
+		if(it.file == p_file)
+		{
+			return;
+		}
+	}
+
+#ifdef __linux__
+	if(m_inotifyFd >= 0)
+	{
+		add_inotify_watch(state);
+	}
+#endif
+
+	m_files.push_back(std::move(state));
+}
+
+void File_watcher::clear()
+{
+	std::lock_guard const lock{m_mutex};
+	m_files.clear();
+
+#ifdef __linux__
+	for(int const watch : m_watches)
+	{
+		inotify_rm_watch(m_inotifyFd, watch);
+	}
+	m_watches.clear();
+#endif
+}
+
+bool File_watcher::wait_stop(std::chrono::milliseconds const p_time)
+{
+	std::unique_lock lock{m_mutex};
+	return m_stopCondition.wait_for(lock, p_time, [this] { return m_stop.load(std::memory_order_relaxed); });
+}
+
+bool File_watcher::poll_changed()
+{
+	bool changed = false;
+	std::lock_guard const lock{m_mutex};
+	for(file_state_t& state : m_files)
+	{
+		std::error_code ec;
+		std::filesystem::file_time_type const mtime = std::filesystem::last_write_time(state.file, ec);
+		uintmax_t const size = std::filesystem::file_size(state.file, ec);
+
+		if(mtime != state.mtime || size != state.size)
+		{
+			state.mtime = mtime;
+			state.size  = size;
+			changed = true;
+		}
+	}
+	return changed;
+}
+
+void File_watcher::run_polling()
+{
+	while(!wait_stop(m_pollInterval))
+	{
+		if(poll_changed())
+		{
+			if(wait_stop(settle_time))
+			{
+				return;
+			}
+			poll_changed();
+			m_callback();
+		}
+	}
+}
+
+#ifdef __linux__
+
+bool File_watcher::add_inotify_watch(file_state_t& p_state)
+{
+	//watch the directory rather than the file, editors and deployment tools usually replace files instead of writing to them
+	std::filesystem::path const directory = p_state.file.parent_path();
+	int const watch = inotify_add_watch(m_inotifyFd, directory.empty() ? "." : directory.c_str(),
+		IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_ATTRIB);
+
+	p_state.watch = watch;
+	if(watch < 0)
+	{
+		return false;
+	}
+	m_watches.push_back(watch);
+	return true;
+}
+
+void File_watcher::run_inotify()
+{
+	alignas(inotify_event) char buffer[4096];
+
+	pollfd fds[2] =
+	{
+		{.fd = m_inotifyFd, .events = POLLIN, .revents = 0},
+		{.fd = m_wakeFd,    .events = POLLIN, .revents = 0},
+	};
+
+	while(!m_stop.load(std::memory_order_relaxed))
+	{
+		if(poll(fds, 2, -1) < 0 || m_stop.load(std::memory_order_relaxed))
+		{
+			continue;
+		}
+
+		bool changed = false;
+		for(;;)
+		{
+			ssize_t const size = read(m_inotifyFd, buffer, sizeof(buffer));
+			if(size <= 0)
+			{
+				break;
+			}
+
+			std::lock_guard const lock{m_mutex};
+			for(char const* it = buffer; it < buffer + size; )
+			{
+				inotify_event const& event = *reinterpret_cast<inotify_event const*>(it);
+				if(event.mask & IN_Q_OVERFLOW)
+				{
+					//events were lost, any of the files may have changed
+					changed = true;
+				}
+				else if(event.len)
+				{
+					//files of different directories may share a name, the event must come from the directory of the file
+					std::string_view const name{event.name};
+					for(file_state_t const& state : m_files)
+					{
+						if(state.watch == event.wd && state.file.filename().native() == name)
+						{
+							changed = true;
+							break;
+						}
+					}
+				}
+				it += sizeof(inotify_event) + event.len;
+			}
+		}
+
+		if(changed)
+		{
+			if(wait_stop(settle_time))
+			{
+				return;
+			}
+
+			//drop whatever arrived while settling, it is covered by this notification
+			while(read(m_inotifyFd, buffer, sizeof(buffer)) > 0);
+			poll_changed();
+			m_callback();
+		}
+	}
+}
+
+#endif
+
+} //namespace pathfinder
@@ -0,0 +1,431 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include "utf_convert.hpp"
+
+#include <algorithm>
+
+#if defined(_M_X64) || defined(__x86_64__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#	define PATHFINDER_SSE2
+#	include <immintrin.h>
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#		define PATHFINDER_TARGET_AVX2
+#	else
+#		define PATHFINDER_TARGET_AVX2 __attribute__((target("avx2")))
+#	endif
+#endif
+
+namespace pathfinder
+{
+namespace
+{
+	//each kernel converts whole blocks of code points from the start of the input for as long as they are in its fast range,
+	//and returns how many it converted, anything left is dealt with by the scalar code
+	using narrow8_t  = uintptr_t (*)(char32_t const* p_input, uintptr_t p_size, char8_t*  p_output);
+	using narrow16_t = uintptr_t (*)(char32_t const* p_input, uintptr_t p_size, char16_t* p_output);
+
+	static constexpr uintptr_t block_size = 16;
+
+	static uintptr_t narrow_none8 (char32_t const*, uintptr_t, char8_t*)  { return 0; }
+	static uintptr_t narrow_none16(char32_t const*, uintptr_t, char16_t*) { return 0; }
+
+#ifdef PATHFINDER_SSE2
+
+	///	\brief Code points below 0x80
+	static uintptr_t narrow_ascii_sse2(char32_t const* const p_input, uintptr_t const p_size, char8_t* const p_output)
+	{
+		__m128i const mask = _mm_set1_epi32(~0x7F);
+		uintptr_t i = 0;
+		for(; i + block_size <= p_size; i += block_size)
+		{
+			__m128i const a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p_input + i));
+			__m128i const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p_input + i + 4));
+			__m128i const c = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p_input + i + 8));
+			__m128i const d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p_input + i + 12));
+
+			__m128i const high = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), mask);
+			if(_mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128())) != 0xFFFF)
+			{
+				break;
+			}
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(p_output + i), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+		}
+		return i;
+	}
+
+	///	\brief Code points in [0x20, 0xFF]
+	static uintptr_t narrow_key_sse2(char32_t const* const p_input, uintptr_t const p_size, char8_t* const p_output)
+	{
+		__m128i const mask  = _mm_set1_epi32(~0xFF);
+		__m128i const lower = _mm_set1_epi32(0x1F);
+		uintptr_t i = 0;
+		for(; i + block_size <= p_size; i += block_size)
+		{
+			__m128i const a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p_input + i));
+			__m128i const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p_input + i + 4));
+			__m128i const c = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p_input + i + 8));
+			__m128i const d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p_input + i + 12));
+
+			//once the upper bits are known to be 0 a signed compare is good enough for the lower bound
+			__m128i const high  = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), mask);
+			__m128i const above = _mm_and_si128(
+				_mm_and_si128(_mm_cmpgt_epi32(a, lower), _mm_cmpgt_epi32(b, lower)),
+				_mm_and_si128(_mm_cmpgt_epi32(c, lower), _mm_cmpgt_epi32(d, lower)));
+			if(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi32(high, _mm_setzero_si128()), above)) != 0xFFFF)
+			{
+				break;
+			}
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(p_output + i), _mm_packus_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+		}
+		return i;
+	}
+
+	///	\brief Code points below 0x10000
+	static uintptr_t narrow_bmp_sse2(char32_t const* const p_input, uintptr_t const p_size, char16_t* const p_output)
+	{
+		__m128i const mask = _mm_set1_epi32(~0xFFFF);
+		//SSE2 has no unsigned 32 to 16 pack, bias the values into the signed range and back
+		__m128i const bias32 = _mm_set1_epi32(0x8000);
+		__m128i const bias16 = _mm_set1_epi16(static_cast<short>(0x8000));
+		uintptr_t i = 0;
+		for(; i + block_size <= p_size; i += block_size)
+		{
+			__m128i const a = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p_input + i));
+			__m128i const b = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p_input + i + 4));
+			__m128i const c = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p_input + i + 8));
+			__m128i const d = _mm_loadu_si128(reinterpret_cast<__m128i const*>(p_input + i + 12));
+
+			__m128i const high = _mm_and_si128(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)), mask);
+			if(_mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128())) != 0xFFFF)
+			{
+				break;
+			}
+
+			__m128i const ab = _mm_add_epi16(_mm_packs_epi32(_mm_sub_epi32(a, bias32), _mm_sub_epi32(b, bias32)), bias16);
+			__m128i const cd = _mm_add_epi16(_mm_packs_epi32(_mm_sub_epi32(c, bias32), _mm_sub_epi32(d, bias32)), bias16);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(p_output + i),     ab);
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(p_output + i + 8), cd);
+		}
+		return i;
+	}
+
+	PATHFINDER_TARGET_AVX2 static inline __m128i pack_bytes_avx2(__m256i const p_1, __m256i const p_2)
+	{
+		//packs work per 128bit lane, put the 16bit values back in order before the last pack
+		__m256i const words = _mm256_permute4x64_epi64(_mm256_packs_epi32(p_1, p_2), 0xD8);
+		return _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+	}
+
+	PATHFINDER_TARGET_AVX2 static uintptr_t narrow_ascii_avx2(char32_t const* const p_input, uintptr_t const p_size, char8_t* const p_output)
+	{
+		__m256i const mask = _mm256_set1_epi32(~0x7F);
+		uintptr_t i = 0;
+		for(; i + block_size <= p_size; i += block_size)
+		{
+			__m256i const a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p_input + i));
+			__m256i const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p_input + i + 8));
+
+			if(!_mm256_testz_si256(_mm256_or_si256(a, b), mask))
+			{
+				break;
+			}
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(p_output + i), pack_bytes_avx2(a, b));
+		}
+		return i;
+	}
+
+	PATHFINDER_TARGET_AVX2 static uintptr_t narrow_key_avx2(char32_t const* const p_input, uintptr_t const p_size, char8_t* const p_output)
+	{
+		__m256i const mask  = _mm256_set1_epi32(~0xFF);
+		__m256i const lower = _mm256_set1_epi32(0x1F);
+		uintptr_t i = 0;
+		for(; i + block_size <= p_size; i += block_size)
+		{
+			__m256i const a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p_input + i));
+			__m256i const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p_input + i + 8));
+
+			if(!_mm256_testz_si256(_mm256_or_si256(a, b), mask) ||
+				_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpgt_epi32(a, lower), _mm256_cmpgt_epi32(b, lower))) != -1)
+			{
+				break;
+			}
+
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(p_output + i), pack_bytes_avx2(a, b));
+		}
+		return i;
+	}
+
+	PATHFINDER_TARGET_AVX2 static uintptr_t narrow_bmp_avx2(char32_t const* const p_input, uintptr_t const p_size, char16_t* const p_output)
+	{
+		__m256i const mask = _mm256_set1_epi32(~0xFFFF);
+		uintptr_t i = 0;
+		for(; i + block_size <= p_size; i += block_size)
+		{
+			__m256i const a = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p_input + i));
+			__m256i const b = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p_input + i + 8));
+
+			if(!_mm256_testz_si256(_mm256_or_si256(a, b), mask))
+			{
+				break;
+			}
+
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(p_output + i), _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xD8));
+		}
+		return i;
+	}
+
+	static bool has_avx2()
+	{
+#ifdef _MSC_VER
+		int info[4];
+		__cpuid(info, 0);
+		if(info[0] < 7)
+		{
+			return false;
+		}
+
+		//AVX state must be enabled by the OS
+		__cpuid(info, 1);
+		constexpr int osxsave_avx = (1 << 27) | (1 << 28);
+		if((info[2] & osxsave_avx) != osxsave_avx || (_xgetbv(0) & 0x6) != 0x6)
+		{
+			return false;
+		}
+
+		__cpuidex(info, 7, 0);
+		return (info[1] & (1 << 5)) != 0;
+#else
+		return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+#endif //PATHFINDER_SSE2
+
+	struct kernels_t
+	{
+		narrow8_t  ascii = narrow_none8;
+		narrow8_t  key   = narrow_none8;
+		narrow16_t bmp   = narrow_none16;
+	};
+
+	static kernels_t select_kernels()
+	{
+		kernels_t res;
+#ifdef PATHFINDER_SSE2
+		if(has_avx2())
+		{
+			res.ascii = narrow_ascii_avx2;
+			res.key   = narrow_key_avx2;
+			res.bmp   = narrow_bmp_avx2;
+		}
+		else
+		{
+			res.ascii = narrow_ascii_sse2;
+			res.key   = narrow_key_sse2;
+			res.bmp   = narrow_bmp_sse2;
+		}
+#endif
+		return res;
+	}
+
+	static kernels_t const g_kernels = select_kernels();
+
+
+#ifdef _WIN32
+	static constexpr uintptr_t max_units = 2;
+
+	static inline uintptr_t narrow_fast(char32_t const* const p_input, uintptr_t const p_size, wchar_t* const p_output)
+	{
+		static_assert(sizeof(wchar_t) == sizeof(char16_t));
+		return g_kernels.bmp(p_input, p_size, reinterpret_cast<char16_t*>(p_output));
+	}
+
+	static inline bool encode(char32_t const p_char, wchar_t*& p_output)
+	{
+		if(p_char < 0x10000)
+		{
+			*(p_output++) = static_cast<wchar_t>(p_char);
+		}
+		else if(p_char < 0x110000)
+		{
+			*(p_output++) = 0xD800 | static_cast<wchar_t>((p_char - 0x010000) >> 10);
+			*(p_output++) = 0xDC00 | static_cast<wchar_t>(p_char & 0x03FF);
+		}
+		else
+		{
+			return false;
+		}
+		return true;
+	}
+#else
+	static constexpr uintptr_t max_units = 4;
+
+	static inline uintptr_t narrow_fast(char32_t const* const p_input, uintptr_t const p_size, char* const p_output)
+	{
+		return g_kernels.ascii(p_input, p_size, reinterpret_cast<char8_t*>(p_output));
+	}
+
+	static inline bool encode(char32_t const p_char, char*& p_output)
+	{
+		if(p_char < 0x00000080) //Level 0
+		{
+			*(p_output++) = static_cast<char>(p_char);
+		}
+		else if(p_char < 0x00000800) //Level 1
+		{
+			*(p_output++) = static_cast<char>(p_char >> 6  ) | static_cast<char>(0xC0);
+			*(p_output++) = static_cast<char>(p_char & 0x3F) | static_cast<char>(0x80);
+		}
+		else if(p_char < 0x00010000) //Level 2
+		{
+			*(p_output++) = static_cast<char>( p_char >> 12        ) | static_cast<char>(0xE0);
+			*(p_output++) = static_cast<char>((p_char >>  6) & 0x3F) | static_cast<char>(0x80);
+			*(p_output++) = static_cast<char>( p_char        & 0x3F) | static_cast<char>(0x80);
+		}
+		else if(p_char < 0x00110000) //Level 3
+		{
+			*(p_output++) = static_cast<char>( p_char >> 18        ) | static_cast<char>(0xF0);
+			*(p_output++) = static_cast<char>((p_char >> 12) & 0x3F) | static_cast<char>(0x80);
+			*(p_output++) = static_cast<char>((p_char >>  6) & 0x3F) | static_cast<char>(0x80);
+			*(p_output++) = static_cast<char>( p_char        & 0x3F) | static_cast<char>(0x80);
+		}
+		else if(p_char & 0x80000000)
+		{
+			//raw bytes carried over from an input that was not valid UTF-8
+			*(p_output++) = static_cast<char>(p_char >> 24);
+			*(p_output++) = static_cast<char>(p_char >> 16);
+			*(p_output++) = static_cast<char>(p_char >>  8);
+			*(p_output++) = static_cast<char>(p_char      );
+		}
+		else
+		{
+			switch(static_cast<uint8_t>(p_char >> 24))
+			{
+			case 3:
+				*(p_output++) = static_cast<char>(p_char >> 16);
+				[[fallthrough]];
+			case 2:
+				*(p_output++) = static_cast<char>(p_char >>  8);
+				*(p_output++) = static_cast<char>(p_char      );
+				break;
+			case 1:
+				*(p_output++) = static_cast<char>(p_char      );
+				break;
+			default:
+				return false;
+			}
+		}
+		return true;
+	}
+#endif
+
+	///	\brief Narrows [\p p_begin, \p p_end) to \p p_output, which can hold max_units per character.
+	///	\return Past the last unit written, nullptr if a character can not be encoded
+	static core::os_char* narrow(char32_t const* p_begin, char32_t const* const p_end, core::os_char* p_output)
+	{
+		while(p_begin != p_end)
+		{
+			uintptr_t const count = narrow_fast(p_begin, static_cast<uintptr_t>(p_end - p_begin), p_output);
+			p_begin  += count;
+			p_output += count;
+
+			//at most one block on the slow path before trying the fast one again
+			for(char32_t const* const block_end = p_begin + std::min<uintptr_t>(block_size, static_cast<uintptr_t>(p_end - p_begin)); p_begin != block_end; ++p_begin)
+			{
+				if(!encode(*p_begin, p_output))
+				{
+					return nullptr;
+				}
+			}
+		}
+		return p_output;
+	}
+
+} //namespace
+
+
+bool append_os(std::u32string_view const p_input, core::os_string& p_output)
+{
+	uintptr_t const old_size = p_output.size();
+	char32_t const* const begin = p_input.data();
+	char32_t const* const end = begin + p_input.size();
+
+#ifdef __cpp_lib_string_resize_and_overwrite
+	//written in place without zero filling the worst case size first
+	bool valid = true;
+	p_output.resize_and_overwrite(old_size + p_input.size() * max_units,
+		[&](core::os_char* const p_data, uintptr_t)
+		{
+			core::os_char* const out = narrow(begin, end, p_data + old_size);
+			valid = out != nullptr;
+			return valid ? static_cast<uintptr_t>(out - p_data) : old_size;
+		});
+	return valid;
+#else
+	//without resize_and_overwrite, growing to the worst case size would zero fill it, narrowed through a buffer instead
+	static constexpr uintptr_t chunk_size = block_size * 4;
+	core::os_char buffer[chunk_size * max_units];
+
+	p_output.reserve(old_size + p_input.size());
+	for(char32_t const* it = begin; it != end; )
+	{
+		char32_t const* const chunk_end = it + std::min<uintptr_t>(chunk_size, static_cast<uintptr_t>(end - it));
+		core::os_char* const out = narrow(it, chunk_end, buffer);
+		if(out == nullptr)
+		{
+			p_output.resize(old_size);
+			return false;
+		}
+		p_output.append(buffer, static_cast<uintptr_t>(out - buffer));
+		it = chunk_end;
+	}
+	return true;
+#endif
+}
+
+bool narrow_key(std::u32string_view const p_input, char8_t* const p_output)
+{
+	uintptr_t const size = p_input.size();
+	uintptr_t i = g_kernels.key(p_input.data(), size, p_output);
+
+	for(; i < size; ++i)
+	{
+		char32_t const tchar = p_input[i];
+		if(tchar < ' ' || tchar > 0xFF)
+		{
+			return false;
+		}
+		p_output[i] = static_cast<char8_t>(tchar);
+	}
+	return true;
+}
+
+} //namespace pathfinder
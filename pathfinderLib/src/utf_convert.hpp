@@ -0,0 +1,47 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+#include <CoreLib/string/core_os_string.hpp>
+
+namespace pathfinder
+{
+	///	\brief Appends \p p_input converted to the native encoding to \p p_output, in a single pass.
+	///	\return false if \p p_input holds a code point that can not be represented, \p p_output is then left unchanged.
+	///	\note Runs of ASCII (or BMP on Windows) are converted with SSE2/AVX2 when available.
+	bool append_os(std::u32string_view p_input, core::os_string& p_output);
+
+	///	\brief Narrows a key to 8bit code units and validates it at the same time.
+	///	\param[out] p_output - Must have room for p_input.size() code units
+	///	\return false if any code point is outside of [0x20, 0xFF], \p p_output content is then unspecified.
+	bool narrow_key(std::u32string_view p_input, char8_t* p_output);
+
+} //namespace pathfinder
@@ -0,0 +1,97 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include "bench_suites.hpp"
+
+#include <array>
+#include <string>
+
+#include "utf_convert.hpp"
+
+namespace pathfinder::bench
+{
+	namespace
+	{
+		static std::u32string make_input(uintptr_t const p_length, bool const p_non_ascii)
+		{
+			static constexpr std::u32string_view ascii = U"data/config/cache/logs_0123456789";
+			static constexpr std::u32string_view mixed = U"donn\u00E9es/\u65E5\u672C\u8A9E/\u00FCbung_\U0001F4C1";
+
+			std::u32string_view const source = p_non_ascii ? mixed : ascii;
+			std::u32string res;
+			res.reserve(p_length);
+			while(res.size() < p_length)
+			{
+				res += source.substr(0, p_length - res.size());
+			}
+			return res;
+		}
+	} //namespace
+
+	void bench_convert(Runner& p_runner, suite_options const&)
+	{
+		static constexpr std::array<uintptr_t, 4> lengths{8, 32, 128, 1024};
+
+		for(uintptr_t const length : lengths)
+		{
+			for(bool const non_ascii : {false, true})
+			{
+				std::string const suffix = std::string{non_ascii ? "utf_" : "ascii_"} + std::to_string(length);
+				std::vector<std::pair<std::string, std::string>> const params{{"code_points", std::to_string(length)}, {"non_ascii", non_ascii ? "true" : "false"}};
+				std::u32string const input = make_input(length, non_ascii);
+
+				core::os_string output;
+				output.reserve(length * 4);
+				p_runner.measure("convert", "append_os_" + suffix, params, 1,
+					[&]()
+					{
+						output.clear();
+						keep(append_os(input, output));
+						keep(output.data());
+					});
+
+				//keys only hold code points up to 0xFF, the non-ASCII variant stays in Latin-1
+				std::u32string key = input;
+				if(non_ascii)
+				{
+					for(char32_t& tchar : key)
+					{
+						tchar = tchar > 0xFF ? U'\u00E9' : tchar;
+					}
+				}
+				std::u8string narrow(key.size(), u8'\0');
+				p_runner.measure("convert", "narrow_key_" + suffix, params, 1,
+					[&]()
+					{
+						keep(narrow_key(key, narrow.data()));
+						keep(narrow.data());
+					});
+			}
+		}
+	}
+
+} //namespace pathfinder::bench
@@ -0,0 +1,186 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include "bench_harness.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <numeric>
+#include <thread>
+
+namespace pathfinder::bench
+{
+	namespace
+	{
+		static double percentile(std::vector<double> const& p_sorted, double const p_ratio)
+		{
+			double const pos = p_ratio * static_cast<double>(p_sorted.size() - 1);
+			uintptr_t const index = static_cast<uintptr_t>(pos);
+			if(index + 1 >= p_sorted.size())
+			{
+				return p_sorted.back();
+			}
+			double const frac = pos - static_cast<double>(index);
+			return p_sorted[index] + (p_sorted[index + 1] - p_sorted[index]) * frac;
+		}
+
+		static void write_string(std::ofstream& p_out, std::string_view const p_str)
+		{
+			p_out.put('"');
+			for(char const tchar : p_str)
+			{
+				switch(tchar)
+				{
+				case '"':  p_out << "\\\""; break;
+				case '\\': p_out << "\\\\"; break;
+				case '\n': p_out << "\\n";  break;
+				case '\t': p_out << "\\t";  break;
+				default:
+					if(static_cast<unsigned char>(tchar) < 0x20)
+					{
+						char buff[8];
+						std::snprintf(buff, sizeof(buff), "\\u%04x", static_cast<unsigned int>(tchar));
+						p_out << buff;
+					}
+					else
+					{
+						p_out.put(tchar);
+					}
+					break;
+				}
+			}
+			p_out.put('"');
+		}
+
+		static void write_number(std::ofstream& p_out, double const p_value)
+		{
+			if(!std::isfinite(p_value))
+			{
+				p_out << "null";
+				return;
+			}
+			char buff[32];
+			std::snprintf(buff, sizeof(buff), "%.3f", p_value);
+			p_out << buff;
+		}
+	} //namespace
+
+	bool Runner::enabled(std::string_view const p_suite, std::string_view const p_name) const
+	{
+		if(m_options.filter.empty())
+		{
+			return true;
+		}
+		std::string full{p_suite};
+		full += '/';
+		full += p_name;
+		return full.find(m_options.filter) != std::string::npos;
+	}
+
+	void Runner::record(std::string_view const p_suite, std::string_view const p_name, std::vector<std::pair<std::string, std::string>> p_params, uint64_t const p_operations, std::vector<double> p_samples_ns, double const p_ops_per_s)
+	{
+		if(p_samples_ns.empty())
+		{
+			return;
+		}
+
+		std::sort(p_samples_ns.begin(), p_samples_ns.end());
+		double const mean = std::accumulate(p_samples_ns.begin(), p_samples_ns.end(), 0.0) / static_cast<double>(p_samples_ns.size());
+
+		record(result_t{
+			.suite      = std::string{p_suite},
+			.name       = std::string{p_name},
+			.params     = std::move(p_params),
+			.samples    = p_samples_ns.size(),
+			.operations = p_operations,
+			.min_ns     = p_samples_ns.front(),
+			.p50_ns     = percentile(p_samples_ns, 0.5),
+			.p99_ns     = percentile(p_samples_ns, 0.99),
+			.p999_ns    = percentile(p_samples_ns, 0.999),
+			.max_ns     = p_samples_ns.back(),
+			.mean_ns    = mean,
+			.ops_per_s  = p_ops_per_s != 0 ? p_ops_per_s : (mean > 0 ? 1e9 / mean : 0)});
+	}
+
+	void Runner::record(result_t p_result)
+	{
+		std::string params;
+		for(std::pair<std::string, std::string> const& param : p_result.params)
+		{
+			params += ' ';
+			params += param.first;
+			params += '=';
+			params += param.second;
+		}
+		std::printf("%-10s %-28s p50 %12.1fns  p99 %12.1fns  %14.0f op/s %s\n",
+			p_result.suite.c_str(), p_result.name.c_str(), p_result.p50_ns, p_result.p99_ns, p_result.ops_per_s, params.c_str());
+		std::fflush(stdout);
+
+		m_results.push_back(std::move(p_result));
+	}
+
+	bool Runner::write_json(std::filesystem::path const& p_file) const
+	{
+		std::ofstream out{p_file, std::ios::binary | std::ios::trunc};
+		if(!out)
+		{
+			return false;
+		}
+
+		out << "{\n\t\"threads\": " << std::thread::hardware_concurrency() << ",\n\t\"results\": [";
+		for(uintptr_t i = 0; i < m_results.size(); ++i)
+		{
+			result_t const& result = m_results[i];
+			out << (i ? ",\n\t\t{" : "\n\t\t{");
+			out << "\"suite\": ";      write_string(out, result.suite);
+			out << ", \"name\": ";     write_string(out, result.name);
+			out << ", \"params\": {";
+			for(uintptr_t j = 0; j < result.params.size(); ++j)
+			{
+				if(j) out << ", ";
+				write_string(out, result.params[j].first);
+				out << ": ";
+				write_string(out, result.params[j].second);
+			}
+			out << "}, \"samples\": " << result.samples;
+			out << ", \"operations\": " << result.operations;
+			out << ", \"min_ns\": ";    write_number(out, result.min_ns);
+			out << ", \"p50_ns\": ";    write_number(out, result.p50_ns);
+			out << ", \"p99_ns\": ";    write_number(out, result.p99_ns);
+			out << ", \"p999_ns\": ";   write_number(out, result.p999_ns);
+			out << ", \"max_ns\": ";    write_number(out, result.max_ns);
+			out << ", \"mean_ns\": ";   write_number(out, result.mean_ns);
+			out << ", \"ops_per_s\": "; write_number(out, result.ops_per_s);
+			out << '}';
+		}
+		out << "\n\t]\n}\n";
+		return static_cast<bool>(out);
+	}
+
+} //namespace pathfinder::bench
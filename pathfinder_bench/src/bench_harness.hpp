@@ -0,0 +1,149 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/// \n
+namespace pathfinder::bench
+{
+
+	///	\brief Prevents the compiler from discarding a value that is otherwise unused.
+	template<typename T>
+	inline void keep(T const& p_value)
+	{
+#if defined(_MSC_VER) && !defined(__clang__)
+		static_cast<void>(*static_cast<T const volatile*>(&p_value));
+#else
+		asm volatile("" : : "r,m"(p_value) : "memory");
+#endif
+	}
+
+	///	\brief Statistics of a measured case, times are per operation.
+	struct result_t
+	{
+		std::string suite;
+		std::string name;
+		std::vector<std::pair<std::string, std::string>> params;
+		uint64_t samples;
+		uint64_t operations;   //!< per sample
+		double   min_ns;
+		double   p50_ns;
+		double   p99_ns;
+		double   p999_ns;
+		double   max_ns;
+		double   mean_ns;
+		double   ops_per_s;   //!< aggregate, for cases that run on several threads
+	};
+
+	///	\brief Runs cases matching a filter and collects their results.
+	class Runner
+	{
+	public:
+		struct options_t
+		{
+			std::string filter;                             //!< only cases whose "suite/name" contains it
+			std::chrono::milliseconds sample_time{5};       //!< minimum duration of a sample
+			std::chrono::milliseconds case_time  {500};     //!< samples are taken until this is reached
+			uint32_t min_samples = 5;
+			uint32_t max_samples = 1000;
+		};
+
+		inline explicit Runner(options_t p_options): m_options{std::move(p_options)} {}
+
+		bool enabled(std::string_view p_suite, std::string_view p_name) const;
+
+		///	\brief Measures \p p_body, which performs \p p_operations operations per call.
+		///	\note The number of calls per sample is calibrated so that a sample lasts at least options_t::sample_time.
+		template<typename Body>
+		void measure(std::string_view p_suite, std::string_view p_name, std::vector<std::pair<std::string, std::string>> p_params, uint64_t p_operations, Body&& p_body)
+		{
+			if(!enabled(p_suite, p_name))
+			{
+				return;
+			}
+
+			using clock = std::chrono::steady_clock;
+
+			//calibration, also serves as warm up
+			uint64_t calls = 1;
+			while(true)
+			{
+				clock::time_point const start = clock::now();
+				for(uint64_t i = 0; i < calls; ++i)
+				{
+					p_body();
+				}
+				clock::duration const elapsed = clock::now() - start;
+				if(elapsed >= m_options.sample_time || calls >= (uint64_t{1} << 40))
+				{
+					break;
+				}
+				calls *= 2;
+			}
+
+			std::vector<double> samples;
+			clock::time_point const case_start = clock::now();
+			while(samples.size() < m_options.max_samples &&
+				(samples.size() < m_options.min_samples || clock::now() - case_start < m_options.case_time))
+			{
+				clock::time_point const start = clock::now();
+				for(uint64_t i = 0; i < calls; ++i)
+				{
+					p_body();
+				}
+				std::chrono::duration<double, std::nano> const elapsed = clock::now() - start;
+				samples.push_back(elapsed.count() / static_cast<double>(calls * p_operations));
+			}
+
+			record(p_suite, p_name, std::move(p_params), calls * p_operations, std::move(samples));
+		}
+
+		///	\brief Adds the statistics of per operation timings measured by the caller.
+		void record(std::string_view p_suite, std::string_view p_name, std::vector<std::pair<std::string, std::string>> p_params, uint64_t p_operations, std::vector<double> p_samples_ns, double p_ops_per_s = 0);
+
+		///	\brief Adds a result as is.
+		void record(result_t p_result);
+
+		inline std::vector<result_t> const& results() const { return m_results; }
+		inline options_t const& options() const { return m_options; }
+
+		///	\brief Writes every result as a JSON document.
+		bool write_json(std::filesystem::path const& p_file) const;
+
+	private:
+		options_t m_options;
+		std::vector<result_t> m_results;
+	};
+
+} //namespace pathfinder::bench
@@ -0,0 +1,96 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include "bench_suites.hpp"
+#include "corpus_generator.hpp"
+
+#include <array>
+#include <cstdio>
+#include <string>
+
+#include <pathfinderLib/pathfinder.hpp>
+
+namespace pathfinder::bench
+{
+	void bench_load(Runner& p_runner, suite_options const& p_options)
+	{
+		static constexpr std::array<uint32_t, 4> sizes{10, 1000, 100000, 1000000};
+
+		struct variant_t
+		{
+			char const* name;
+			bool        env;
+			bool        non_ascii;
+		};
+		static constexpr std::array<variant_t, 4> variants
+		{
+			variant_t{.name = "plain",   .env = false, .non_ascii = false},
+			variant_t{.name = "env",     .env = true,  .non_ascii = false},
+			variant_t{.name = "utf",     .env = false, .non_ascii = true },
+			variant_t{.name = "env_utf", .env = true,  .non_ascii = true },
+		};
+
+		for(uint32_t const size : sizes)
+		{
+			if(size > p_options.max_keys)
+			{
+				continue;
+			}
+			for(variant_t const& variant : variants)
+			{
+				std::string const name = std::string{"load_"} + variant.name + '_' + std::to_string(size);
+				if(!p_runner.enabled("load", name))
+				{
+					continue;
+				}
+
+				corpus_t const corpus = generate_corpus(p_options.work_directory,
+					corpus_options{.keys = size, .env = variant.env, .non_ascii = variant.non_ascii});
+				if(corpus.file.empty())
+				{
+					std::fprintf(stderr, "Unable to write corpus to %s\n", p_options.work_directory.string().c_str());
+					return;
+				}
+
+				Count_log log;
+				p_runner.measure("load", name, {{"keys", std::to_string(size)}, {"variant", variant.name}}, 1,
+					[&]()
+					{
+						PathFinder finder;
+						finder.load(corpus.file, log, LoadFlag::None, &corpus.environment);
+						keep(finder);
+					});
+
+				if(log.errors.load() != 0)
+				{
+					std::fprintf(stderr, "load/%s reported %llu errors\n", name.c_str(), static_cast<unsigned long long>(log.errors.load()));
+				}
+			}
+		}
+	}
+
+} //namespace pathfinder::bench
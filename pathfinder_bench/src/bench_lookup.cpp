@@ -0,0 +1,139 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include "bench_suites.hpp"
+#include "corpus_generator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <pathfinderLib/pathfinder.hpp>
+
+namespace pathfinder::bench
+{
+	namespace
+	{
+		///	\brief Number of lookups per measured call, large enough to hide the loop and timer overhead
+		static constexpr uintptr_t lookup_batch = 1024;
+
+		///	\brief Picks \ref lookup_batch keys in random order, so that consecutive lookups do not hit the same cache lines.
+		static std::vector<std::u8string_view> lookup_order(std::vector<std::u8string> const& p_keys, Random& p_random)
+		{
+			std::vector<std::u8string_view> res;
+			res.reserve(lookup_batch);
+			for(uintptr_t i = 0; i < lookup_batch; ++i)
+			{
+				res.push_back(p_keys[p_random.next() % p_keys.size()]);
+			}
+			return res;
+		}
+	} //namespace
+
+	void bench_lookup(Runner& p_runner, suite_options const& p_options)
+	{
+		static constexpr std::array<uint32_t, 4> sizes{10, 1000, 100000, 1000000};
+
+		struct length_t
+		{
+			char const* name;
+			uint32_t    min;
+			uint32_t    max;
+		};
+		static constexpr std::array<length_t, 3> lengths
+		{
+			length_t{.name = "short", .min = 4,  .max = 12},
+			length_t{.name = "mixed", .min = 8,  .max = 48},
+			length_t{.name = "long",  .min = 64, .max = 128},
+		};
+
+		for(uint32_t const size : sizes)
+		{
+			if(size > p_options.max_keys)
+			{
+				continue;
+			}
+			for(length_t const& length : lengths)
+			{
+				std::string const suffix = std::string{length.name} + '_' + std::to_string(size);
+				if(!p_runner.enabled("lookup", "hit_" + suffix) && !p_runner.enabled("lookup", "miss_" + suffix))
+				{
+					continue;
+				}
+
+				corpus_t const corpus = generate_corpus(p_options.work_directory,
+					corpus_options{.keys = size, .min_key_length = length.min, .max_key_length = length.max});
+				if(corpus.file.empty())
+				{
+					std::fprintf(stderr, "Unable to write corpus to %s\n", p_options.work_directory.string().c_str());
+					return;
+				}
+
+				Count_log log;
+				PathFinder finder;
+				if(!finder.load(corpus.file, log, LoadFlag::None, &corpus.environment))
+				{
+					std::fprintf(stderr, "Unable to load %s\n", corpus.file.string().c_str());
+					continue;
+				}
+
+				//misses share the length distribution of the hits, '!' is never used by the generator
+				std::vector<std::u8string> missing = corpus.keys;
+				for(std::u8string& key : missing)
+				{
+					key.back() = u8'!';
+				}
+
+				Random random{size};
+				std::vector<std::u8string_view> const hits   = lookup_order(corpus.keys, random);
+				std::vector<std::u8string_view> const misses = lookup_order(missing, random);
+				std::vector<std::pair<std::string, std::string>> const params{{"keys", std::to_string(size)}, {"key_length", std::to_string(length.min) + '-' + std::to_string(length.max)}};
+
+				p_runner.measure("lookup", "hit_" + suffix, params, lookup_batch,
+					[&]()
+					{
+						for(std::u8string_view const key : hits)
+						{
+							keep(&finder.get_path(key));
+						}
+					});
+
+				p_runner.measure("lookup", "miss_" + suffix, params, lookup_batch,
+					[&]()
+					{
+						for(std::u8string_view const key : misses)
+						{
+							keep(&finder.get_path(key));
+						}
+					});
+			}
+		}
+	}
+
+} //namespace pathfinder::bench
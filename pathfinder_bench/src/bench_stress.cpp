@@ -0,0 +1,320 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include "bench_suites.hpp"
+#include "corpus_generator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pathfinder/pathfinder.hpp>
+#include <pathfinder/pathfinder_handle.hpp>
+#include <pathfinder/pathfinder_service.hpp>
+#include <pathfinderLib/pathfinder_flags.hpp>
+
+namespace pathfinder::bench
+{
+	namespace
+	{
+		///	\brief Every lookup is checked, only one in this many is timed so that the clock does not dominate
+		static constexpr uint32_t latency_stride = 64;
+
+		///	\brief Handles kept by a reader before they are checked again, and released along with path_quiescent
+		static constexpr uintptr_t held_references = 16;
+		static constexpr uint32_t  held_stride = 256;
+		static constexpr uint32_t  quiescent_period = 4096;
+
+		///	\brief Both configurations define the same keys, each value names its configuration and key,
+		///		so a reader can tell a path from either configuration apart from a torn or freed one.
+		struct stress_config_t
+		{
+			std::filesystem::path files[2];
+			std::vector<std::u8string> keys;
+			std::vector<core::os_string> expected[2];
+		};
+
+		static bool write_configs(std::filesystem::path const& p_directory, uint32_t const p_keys, stress_config_t& p_out)
+		{
+			Random random{p_keys};
+			p_out.keys.clear();
+			for(uint32_t i = 0; i < p_keys; ++i)
+			{
+				p_out.keys.push_back(make_key(random, i, 8, 32));
+			}
+
+			for(uintptr_t config = 0; config < 2; ++config)
+			{
+				char const tag = config ? 'B' : 'A';
+				p_out.files[config] = p_directory / (std::string{"stress_"} + tag + ".scef");
+				p_out.expected[config].clear();
+
+				std::string text = "!SCEF:V1\n<pathfinder:\n";
+				for(uint32_t i = 0; i < p_keys; ++i)
+				{
+					std::string const value = std::string{"stress/"} + tag + '/' + std::to_string(i);
+					text += "\t\"";
+					text.append(reinterpret_cast<char const*>(p_out.keys[i].data()), p_out.keys[i].size());
+					text += "\" = \"" + value + "\";\n";
+					p_out.expected[config].push_back((p_directory / value).lexically_normal().native());
+				}
+				text += ">\n";
+
+				std::ofstream out{p_out.files[config], std::ios::binary | std::ios::trunc};
+				out.write(text.data(), static_cast<std::streamsize>(text.size()));
+				if(!out)
+				{
+					return false;
+				}
+			}
+			return true;
+		}
+
+		struct reader_result_t
+		{
+			uint64_t lookups  = 0;
+			uint64_t torn     = 0; //!< paths that matched neither configuration
+			uint64_t dangling = 0; //!< paths whose content changed while they were supposed to stay valid
+			std::vector<double> latencies_ns;
+		};
+
+		static void reader(stress_config_t const& p_config, std::atomic<bool> const& p_stop, uint64_t const p_seed, reader_result_t& p_result)
+		{
+			using clock = std::chrono::steady_clock;
+
+			struct held_t
+			{
+				path_handle handle;
+				uint32_t    index;
+			};
+			std::array<held_t, held_references> held;
+			uintptr_t held_count = 0;
+
+			//a reference stays valid until the same thread looked up paths in 4 newer tables,
+			//it is kept and checked before every lookup for as long as that can not have happened
+			std::filesystem::path const* kept = nullptr;
+			uint32_t kept_index = 0;
+			uint64_t kept_generation = 0;
+
+			auto const valid = [&p_config](core::os_string_view const p_path, uint32_t const p_index)
+			{
+				return p_path == p_config.expected[0][p_index] || p_path == p_config.expected[1][p_index];
+			};
+
+			Random random{p_seed};
+			uint32_t const size = static_cast<uint32_t>(p_config.keys.size());
+			p_result.latencies_ns.reserve(1 << 20);
+
+			while(!p_stop.load(std::memory_order_relaxed))
+			{
+				for(uint32_t i = 0; i < quiescent_period; ++i)
+				{
+					uint32_t const index = static_cast<uint32_t>(random.next() % size);
+					std::u8string_view const key = p_config.keys[index];
+
+					if(kept && path_generation() - kept_generation < 4)
+					{
+						if(!valid(kept->native(), kept_index))
+						{
+							++p_result.dangling;
+						}
+					}
+					else
+					{
+						kept = nullptr;
+					}
+
+					uint64_t const generation = path_generation();
+					std::filesystem::path const* path;
+					if(i % latency_stride == 0)
+					{
+						clock::time_point const start = clock::now();
+						path = &path_find(key);
+						std::chrono::duration<double, std::nano> const elapsed = clock::now() - start;
+						p_result.latencies_ns.push_back(elapsed.count());
+					}
+					else
+					{
+						path = &path_find(key);
+					}
+
+					//empty while the table is cleared
+					if(path->empty())
+					{
+						continue;
+					}
+					if(!valid(path->native(), index))
+					{
+						++p_result.torn;
+						continue;
+					}
+					if(kept == nullptr)
+					{
+						kept = path;
+						kept_index = index;
+						kept_generation = generation;
+					}
+
+					if(i % held_stride == 0)
+					{
+						held[held_count++ % held_references] = held_t{.handle = path_acquire(key), .index = index};
+					}
+				}
+				p_result.lookups += quiescent_period;
+
+				//handles keep their path alive regardless of the tables published since
+				for(uintptr_t i = 0, end = std::min(held_count, held_references); i < end; ++i)
+				{
+					if(held[i].handle.found() && !valid(held[i].handle.path().native(), held[i].index))
+					{
+						++p_result.dangling;
+					}
+					held[i].handle.release();
+				}
+				held_count = 0;
+				kept = nullptr;
+				path_quiescent();
+			}
+			path_quiescent();
+		}
+	} //namespace
+
+	stress_result bench_stress(Runner& p_runner, suite_options const& p_options)
+	{
+		uint32_t const hardware = std::max(std::thread::hardware_concurrency(), 2u);
+
+		std::vector<uint32_t> thread_counts;
+		//one core is left to the writer
+		for(uint32_t count = 1; count < hardware; count *= 2)
+		{
+			thread_counts.push_back(count);
+		}
+		if(thread_counts.back() != hardware - 1)
+		{
+			thread_counts.push_back(hardware - 1);
+		}
+
+		stress_config_t config;
+		bool prepared = false;
+		stress_result res = stress_result::Safe;
+
+		for(uint32_t const threads : thread_counts)
+		{
+			std::string const name = "reload_readers_" + std::to_string(threads);
+			if(!p_runner.enabled("stress", name))
+			{
+				continue;
+			}
+
+			if(!prepared)
+			{
+				if(!write_configs(p_options.work_directory, std::min<uint32_t>(p_options.max_keys, 10000), config))
+				{
+					std::fprintf(stderr, "Unable to write stress configurations to %s\n", p_options.work_directory.string().c_str());
+					return stress_result::SetupFailed;
+				}
+				prepared = true;
+			}
+
+			Count_log log;
+			if(!reload_pathfinder(config.files[0], log))
+			{
+				std::fprintf(stderr, "Unable to load %s\n", config.files[0].string().c_str());
+				return stress_result::SetupFailed;
+			}
+
+			std::atomic<bool> stop = false;
+			std::vector<reader_result_t> results(threads);
+			std::vector<std::thread> readers;
+			for(uint32_t i = 0; i < threads; ++i)
+			{
+				readers.emplace_back(reader, std::cref(config), std::cref(stop), uint64_t{i} + 1, std::ref(results[i]));
+			}
+
+			//alternate configurations, going through an empty table now and then
+			uint64_t reloads = 0;
+			std::chrono::steady_clock::time_point const start = std::chrono::steady_clock::now();
+			while(std::chrono::steady_clock::now() - start < p_runner.options().case_time)
+			{
+				std::filesystem::path const& file = config.files[(reloads + 1) % 2];
+				if(reloads % 8 == 7)
+				{
+					clear_pathfinder();
+					load_pathfinder(file, log);
+				}
+				else
+				{
+					reload_pathfinder(file, log);
+				}
+				++reloads;
+			}
+			stop.store(true, std::memory_order_relaxed);
+			for(std::thread& thread : readers)
+			{
+				thread.join();
+			}
+			std::chrono::duration<double> const elapsed = std::chrono::steady_clock::now() - start;
+			clear_pathfinder();
+
+			reader_result_t total;
+			for(reader_result_t& result : results)
+			{
+				total.lookups  += result.lookups;
+				total.torn     += result.torn;
+				total.dangling += result.dangling;
+				total.latencies_ns.insert(total.latencies_ns.end(), result.latencies_ns.begin(), result.latencies_ns.end());
+			}
+
+			double const throughput = static_cast<double>(total.lookups) / elapsed.count();
+			p_runner.record("stress", name,
+				{
+					{"threads",            std::to_string(threads)},
+					{"keys",               std::to_string(config.keys.size())},
+					{"reloads",            std::to_string(reloads)},
+					{"ops_per_s_per_core", std::to_string(static_cast<uint64_t>(throughput / threads))},
+					{"torn",               std::to_string(total.torn)},
+					{"dangling",           std::to_string(total.dangling)},
+					{"load_errors",        std::to_string(log.errors.load())},
+				},
+				1, std::move(total.latencies_ns), throughput);
+
+			if(total.torn || total.dangling)
+			{
+				std::fprintf(stderr, "stress/%s detected %llu torn and %llu dangling reads\n", name.c_str(),
+					static_cast<unsigned long long>(total.torn), static_cast<unsigned long long>(total.dangling));
+				res = stress_result::Unsafe;
+			}
+		}
+		return res;
+	}
+
+} //namespace pathfinder::bench
@@ -0,0 +1,81 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+
+#include <pathfinderLib/pathfinder_prelog_proxy.hpp>
+
+#include "bench_harness.hpp"
+
+/// \n
+namespace pathfinder::bench
+{
+
+	///	\brief Discards diagnostics, only counting errors so that a broken corpus does not go unnoticed.
+	class Count_log final: public Log_proxy
+	{
+	public:
+		inline Count_log() { set_filter(logger::Level::Error); }
+
+		void push2log(core::os_string_view, uint32_t, uint32_t, logger::Level, std::u8string_view) final
+		{
+			errors.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		std::atomic<uint64_t> errors = 0;
+	};
+
+	struct suite_options
+	{
+		std::filesystem::path work_directory; //!< Where synthetic corpora are written
+		uint32_t              max_keys;       //!< Largest corpus generated
+	};
+
+	///	\brief PathFinder::load on synthetic corpora.
+	void bench_load(Runner& p_runner, suite_options const& p_options);
+
+	///	\brief PathFinder::get_path hits and misses.
+	void bench_lookup(Runner& p_runner, suite_options const& p_options);
+
+	///	\brief Conversion kernels used while resolving values.
+	void bench_convert(Runner& p_runner, suite_options const& p_options);
+
+	enum class stress_result: uint8_t
+	{
+		Safe,
+		Unsafe,       //!< a reader saw a torn or dangling path
+		SetupFailed,  //!< the configurations could not be written or loaded, nothing was measured
+	};
+
+	///	\brief Lookups through the exported path_find on several threads while another thread keeps reloading.
+	stress_result bench_stress(Runner& p_runner, suite_options const& p_options);
+
+} //namespace pathfinder::bench
@@ -0,0 +1,184 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include "corpus_generator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <fstream>
+
+namespace pathfinder::bench
+{
+	namespace
+	{
+		//SCEF escape for a code point 0, which delimits environment variable names in a value
+		static constexpr std::string_view env_delimiter = "^x0;";
+
+		static constexpr std::array<std::string_view, 4> env_names
+		{
+			"BENCH_ROOT",
+			"BENCH_DATA",
+			"BENCH_CACHE",
+			"BENCH_USER",
+		};
+
+		static constexpr std::array<std::string_view, 8> ascii_elements
+		{
+			"data", "config", "cache", "logs", "plugins", "resources", "shaders", "tmp",
+		};
+
+		static constexpr std::array<std::string_view, 6> non_ascii_elements
+		{
+			"donn\xC3\xA9" "es",
+			"\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E",
+			"\xD0\xB4\xD0\xB0\xD0\xBD\xD0\xBD\xD1\x8B\xD0\xB5",
+			"\xC3\xBC" "bung",
+			"\xF0\x9F\x93\x81",
+			"\xCE\xB1\xCF\x81\xCF\x87\xCE\xB5\xE1\xBF\x96\xCE\xBF",
+		};
+
+		static constexpr char key_chars[] = "abcdefghijklmnopqrstuvwxyz0123456789_.";
+
+		static void append_value(Random& p_random, corpus_options const& p_options, std::string& p_out)
+		{
+			if(p_options.env && p_random.range(0, 3) != 0)
+			{
+				p_out += env_delimiter;
+				p_out += env_names[p_random.range(0, env_names.size() - 1)];
+				p_out += env_delimiter;
+				p_out += '/';
+			}
+			else if(p_random.range(0, 7) == 0)
+			{
+#ifdef _WIN32
+				p_out += "C:/";
+#else
+				p_out += '/';
+#endif
+			}
+
+			uint32_t const depth = p_random.range(1, 5);
+			for(uint32_t i = 0; i < depth; ++i)
+			{
+				if(i)
+				{
+					p_out += '/';
+				}
+				if(p_options.non_ascii && p_random.range(0, 2) == 0)
+				{
+					p_out += non_ascii_elements[p_random.range(0, non_ascii_elements.size() - 1)];
+				}
+				else
+				{
+					p_out += ascii_elements[p_random.range(0, ascii_elements.size() - 1)];
+				}
+				if(p_random.range(0, 9) == 0)
+				{
+					p_out += "/..";
+				}
+			}
+			p_out += '/';
+			p_out += std::to_string(p_random.range(0, 9999));
+		}
+
+		static core::os_string to_os(std::string_view const p_ascii)
+		{
+			return core::os_string{p_ascii.begin(), p_ascii.end()};
+		}
+	} //namespace
+
+	std::u8string make_key(Random& p_random, uint32_t p_index, uint32_t const p_min, uint32_t const p_max)
+	{
+		//the index is written in base 36 at the end, the rest is filler
+		std::u8string suffix;
+		do
+		{
+			suffix.insert(suffix.begin(), static_cast<char8_t>(key_chars[p_index % 36]));
+			p_index /= 36;
+		}
+		while(p_index);
+		suffix.insert(suffix.begin(), u8'_');
+
+		uint32_t const length = std::max<uint32_t>(p_random.range(p_min, p_max), static_cast<uint32_t>(suffix.size()) + 1);
+		std::u8string res;
+		res.reserve(length);
+		while(res.size() + suffix.size() < length)
+		{
+			res.push_back(static_cast<char8_t>(key_chars[p_random.range(0, sizeof(key_chars) - 2)]));
+		}
+		return res + suffix;
+	}
+
+	std::string corpus_name(corpus_options const& p_options)
+	{
+		std::string res = "corpus_" + std::to_string(p_options.keys) + "_k" + std::to_string(p_options.min_key_length) + '-' + std::to_string(p_options.max_key_length);
+		if(p_options.env)
+		{
+			res += "_env";
+		}
+		if(p_options.non_ascii)
+		{
+			res += "_utf";
+		}
+		return res;
+	}
+
+	corpus_t generate_corpus(std::filesystem::path const& p_directory, corpus_options const& p_options)
+	{
+		corpus_t res;
+		res.file = p_directory / (corpus_name(p_options) + ".scef");
+		res.keys.reserve(p_options.keys);
+
+		for(std::string_view const name : env_names)
+		{
+			res.environment.set(to_os(name), to_os(std::string{"/bench/"} + std::string{name}));
+		}
+
+		Random random{p_options.seed};
+		std::string text = "!SCEF:V1\n<pathfinder:\n";
+		for(uint32_t i = 0; i < p_options.keys; ++i)
+		{
+			std::u8string key = make_key(random, i, p_options.min_key_length, p_options.max_key_length);
+			text += "\t\"";
+			text.append(reinterpret_cast<char const*>(key.data()), key.size());
+			text += "\" = \"";
+			append_value(random, p_options, text);
+			text += "\";\n";
+			res.keys.push_back(std::move(key));
+		}
+		text += ">\n";
+
+		std::ofstream out{res.file, std::ios::binary | std::ios::trunc};
+		out.write(text.data(), static_cast<std::streamsize>(text.size()));
+		if(!out)
+		{
+			res.file.clear();
+		}
+		return res;
+	}
+
+} //namespace pathfinder::bench
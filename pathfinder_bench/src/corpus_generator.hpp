@@ -0,0 +1,94 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <pathfinderLib/pathfinder_environment.hpp>
+
+/// \n
+namespace pathfinder::bench
+{
+
+	///	\brief Small deterministic generator, so that corpora are identical across runs and machines.
+	class Random
+	{
+	public:
+		inline explicit Random(uint64_t const p_seed): m_state{p_seed} {}
+
+		///	\brief splitmix64
+		inline uint64_t next()
+		{
+			uint64_t res = (m_state += 0x9E3779B97F4A7C15);
+			res = (res ^ (res >> 30)) * 0xBF58476D1CE4E5B9;
+			res = (res ^ (res >> 27)) * 0x94D049BB133111EB;
+			return res ^ (res >> 31);
+		}
+
+		///	\return A value in [p_min, p_max]
+		inline uint32_t range(uint32_t const p_min, uint32_t const p_max)
+		{
+			return p_min + static_cast<uint32_t>(next() % (uint64_t{p_max} - p_min + 1));
+		}
+
+	private:
+		uint64_t m_state;
+	};
+
+	struct corpus_options
+	{
+		uint32_t keys           = 1000;
+		uint32_t min_key_length = 8;
+		uint32_t max_key_length = 24;
+		bool     env            = false; //!< Values reference environment variables
+		bool     non_ascii      = false; //!< Values hold non-ASCII path elements
+		uint64_t seed           = 1;
+	};
+
+	struct corpus_t
+	{
+		std::filesystem::path     file;
+		std::vector<std::u8string> keys;        //!< In the order they appear in the file
+		Environment               environment; //!< Defines every variable the values reference
+	};
+
+	///	\brief Writes a synthetic "pathfinder" file into \p p_directory.
+	///	\note The file name is derived from the options, an existing file is overwritten.
+	corpus_t generate_corpus(std::filesystem::path const& p_directory, corpus_options const& p_options);
+
+	///	\brief Unique key of length in [p_min, p_max], \p p_index makes it unique.
+	std::u8string make_key(Random& p_random, uint32_t p_index, uint32_t p_min, uint32_t p_max);
+
+	///	\brief Describes the options, for file names and result parameters.
+	std::string corpus_name(corpus_options const& p_options);
+
+} //namespace pathfinder::bench
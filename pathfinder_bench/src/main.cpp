@@ -0,0 +1,135 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include <charconv>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "bench_harness.hpp"
+#include "bench_suites.hpp"
+
+namespace
+{
+	static void print_usage()
+	{
+		std::puts(
+			"pathfinder_bench [options]\n"
+			"  --filter <text>    only run cases whose \"suite/name\" contains <text>\n"
+			"  --json <file>      write the results to <file> as JSON\n"
+			"  --dir <directory>  where to generate the synthetic corpora (default: temporary directory)\n"
+			"  --max-keys <n>     skip corpora with more than <n> keys (default: 1000000)\n"
+			"  --case-ms <n>      minimum time spent measuring each case (default: 500)\n"
+			"exits with 1 on invalid options or if a suite could not be set up,\n"
+			"with 2 if the stress suite detected a torn or dangling read");
+	}
+
+	static bool parse_number(std::string_view const p_text, uint32_t& p_out)
+	{
+		std::from_chars_result const res = std::from_chars(p_text.data(), p_text.data() + p_text.size(), p_out);
+		return res.ec == std::errc{} && res.ptr == p_text.data() + p_text.size();
+	}
+} //namespace
+
+int main(int const argc, char const* const* const argv)
+{
+	using namespace pathfinder::bench;
+
+	Runner::options_t options;
+	suite_options suite{.work_directory = {}, .max_keys = 1000000};
+	std::filesystem::path json;
+
+	for(int i = 1; i < argc; ++i)
+	{
+		std::string_view const arg = argv[i];
+		bool const has_value = i + 1 < argc;
+		uint32_t number = 0;
+
+		if(arg == "--filter" && has_value)
+		{
+			options.filter = argv[++i];
+		}
+		else if(arg == "--json" && has_value)
+		{
+			json = argv[++i];
+		}
+		else if(arg == "--dir" && has_value)
+		{
+			suite.work_directory = argv[++i];
+		}
+		else if(arg == "--max-keys" && has_value && parse_number(argv[i + 1], number))
+		{
+			suite.max_keys = number;
+			++i;
+		}
+		else if(arg == "--case-ms" && has_value && parse_number(argv[i + 1], number))
+		{
+			options.case_time = std::chrono::milliseconds{number};
+			++i;
+		}
+		else
+		{
+			print_usage();
+			return arg == "--help" ? 0 : 1;
+		}
+	}
+
+	std::error_code ec;
+	if(suite.work_directory.empty())
+	{
+		suite.work_directory = std::filesystem::temp_directory_path(ec) / "pathfinder_bench";
+	}
+	std::filesystem::create_directories(suite.work_directory, ec);
+	if(ec != std::error_code{})
+	{
+		std::fprintf(stderr, "Unable to create %s\n", suite.work_directory.string().c_str());
+		return 1;
+	}
+
+	Runner runner{std::move(options)};
+	bench_convert(runner, suite);
+	bench_lookup (runner, suite);
+	bench_load   (runner, suite);
+	stress_result const stress = bench_stress(runner, suite);
+
+	if(!json.empty() && !runner.write_json(json))
+	{
+		std::fprintf(stderr, "Unable to write %s\n", json.string().c_str());
+		return 1;
+	}
+	switch(stress)
+	{
+	case stress_result::Unsafe:
+		return 2;
+	case stress_result::SetupFailed:
+		return 1;
+	default:
+		return 0;
+	}
+}
@@ -0,0 +1,188 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <new>
+#include <random>
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include <SCEF/SCEF.hpp>
+
+#include <pathfinderLib/pathfinder.hpp>
+#include <pathfinderLib/pathfinder_environment.hpp>
+#include <pathfinderLib/pathfinder_prelog_proxy.hpp>
+
+//======== Allocation counting ========
+//every allocation of the process goes through these, counted only while a test asks for it
+
+namespace
+{
+	static std::atomic<bool>     g_counting    = false;
+	static std::atomic<uint64_t> g_allocations = 0;
+
+	static void* counted_alloc(std::size_t const p_size, std::size_t const p_alignment)
+	{
+		if(g_counting.load(std::memory_order_relaxed))
+		{
+			g_allocations.fetch_add(1, std::memory_order_relaxed);
+		}
+
+		std::size_t const size = p_size ? p_size : 1;
+		void* const res =
+#ifdef _WIN32
+			_aligned_malloc(size, p_alignment);
+#else
+			std::aligned_alloc(p_alignment, (size + p_alignment - 1) / p_alignment * p_alignment);
+#endif
+		if(res == nullptr)
+		{
+			throw std::bad_alloc{};
+		}
+		return res;
+	}
+
+	static void counted_free(void* const p_ptr)
+	{
+#ifdef _WIN32
+		_aligned_free(p_ptr);
+#else
+		std::free(p_ptr);
+#endif
+	}
+} //namespace
+
+void* operator new(std::size_t const p_size) { return counted_alloc(p_size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(std::size_t const p_size, std::align_val_t const p_alignment) { return counted_alloc(p_size, static_cast<std::size_t>(p_alignment)); }
+void operator delete(void* const p_ptr) noexcept { counted_free(p_ptr); }
+void operator delete(void* const p_ptr, std::size_t) noexcept { counted_free(p_ptr); }
+void operator delete(void* const p_ptr, std::align_val_t) noexcept { counted_free(p_ptr); }
+void operator delete(void* const p_ptr, std::size_t, std::align_val_t) noexcept { counted_free(p_ptr); }
+
+namespace
+{
+	using namespace pathfinder;
+
+	class Null_log final: public Log_proxy
+	{
+	public:
+		void push2log(core::os_string_view, uint32_t, uint32_t, logger::Level, std::u8string_view) final {}
+	};
+
+	class allocation_scope
+	{
+	public:
+		allocation_scope()
+		{
+			g_allocations.store(0, std::memory_order_relaxed);
+			g_counting.store(true, std::memory_order_seq_cst);
+		}
+
+		~allocation_scope() { stop(); }
+
+		uint64_t stop()
+		{
+			g_counting.store(false, std::memory_order_seq_cst);
+			return g_allocations.load(std::memory_order_relaxed);
+		}
+	};
+
+	///	\brief Keys and path components are kept short enough for the small string optimization,
+	///		so that only the allocations made per entry are counted and not the ones of long strings.
+	static std::filesystem::path write_file(std::filesystem::path const& p_directory, uint32_t const p_keys)
+	{
+		std::filesystem::path const file = p_directory / ("k" + std::to_string(p_keys) + ".scef");
+		std::string text = "!SCEF:V1\n<pathfinder:\n";
+		for(uint32_t i = 0; i < p_keys; ++i)
+		{
+			text += "\t\"k" + std::to_string(i) + "\" = \"d/" + std::to_string(i) + "\";\n";
+		}
+		text += ">\n";
+
+		std::ofstream out{file, std::ios::binary | std::ios::trunc};
+		out.write(text.data(), static_cast<std::streamsize>(text.size()));
+		return file;
+	}
+
+	///	\brief Allocations of loading \p p_file, less the ones of parsing it
+	static uint64_t load_allocations(std::filesystem::path const& p_file, Environment const& p_environment)
+	{
+		uint64_t parse;
+		{
+			scef::document document;
+			allocation_scope scope;
+			document.load(p_file, scef::Flag::DisableSpacers | scef::Flag::DisableComments | scef::Flag::ForceHeader,
+				[](scef::Error_Context const&, void*) { return scef::warningBehaviour::Default; }, nullptr);
+			parse = scope.stop();
+		}
+
+		Null_log log;
+		PathFinder finder;
+		allocation_scope scope;
+		EXPECT_TRUE(finder.load(p_file, log, LoadFlag::None, &p_environment));
+		uint64_t const load = scope.stop();
+		EXPECT_GE(load, parse);
+		return load - parse;
+	}
+} //namespace
+
+//======== Tests ========
+
+///	\brief Allocations made per entry when resolving a file.
+///	\note Measured as the difference between two loads, so that the fixed cost of a load and of its worker threads cancels out.
+///		Entries are stored along with their key and path by the arena of the worker that resolved them,
+///		their std::filesystem::path is only created when it is looked up.
+TEST(Allocations, per_entry)
+{
+	//unique per run so that concurrent runs do not overwrite each other's files
+	std::filesystem::path const directory = std::filesystem::temp_directory_path() /
+		("pf_alloc_" + std::to_string(std::random_device{}()) + "_" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()));
+	ASSERT_TRUE(std::filesystem::create_directories(directory));
+
+	constexpr uint32_t keys = 8192;
+	std::filesystem::path const small = write_file(directory, keys);
+	std::filesystem::path const large = write_file(directory, keys * 2);
+
+	Environment const environment;
+	uint64_t const small_count = load_allocations(small, environment);
+	uint64_t const large_count = load_allocations(large, environment);
+
+	double const per_entry = static_cast<double>(large_count - small_count) / keys;
+	RecordProperty("allocations_per_entry", std::to_string(per_entry));
+
+	//the arrays and arena blocks of a load grow in steps, which amortizes to a small fraction of an allocation per entry
+	EXPECT_LE(per_entry, 1.0);
+
+	std::error_code ec;
+	std::filesystem::remove_all(directory, ec);
+}
@@ -0,0 +1,156 @@
+//======== ======== ======== ======== ======== ======== ======== ========
+///	\file
+///
+///	\copyright
+///		Copyright (c) Tiago Miguel Oliveira Freire
+///
+///		Permission is hereby granted, free of charge, to any person obtaining a copy
+///		of this software and associated documentation files (the "Software"),
+///		to copy, modify, publish, and/or distribute copies of the Software,
+///		and to permit persons to whom the Software is furnished to do so,
+///		subject to the following conditions:
+///
+///		The copyright notice and this permission notice shall be included in all
+///		copies or substantial portions of the Software.
+///		The copyrighted work, or derived works, shall not be used to train
+///		Artificial Intelligence models of any sort; or otherwise be used in a
+///		transformative way that could obfuscate the source of the copyright.
+///
+///		THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+///		IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+///		FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+///		AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+///		LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+///		OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+///		SOFTWARE.
+//======== ======== ======== ======== ======== ======== ======== ========
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <pathfinderLib/pathfinder_prelog_store.hpp>
+
+using namespace pathfinder;
+
+namespace
+{
+	static constexpr uint32_t producers = 8;
+	static constexpr uint32_t messages  = 4000;
+	static constexpr uint32_t files     = 4;
+
+	static std::u8string make_message(uint32_t const p_producer, uint32_t const p_index)
+	{
+		std::string const text = "message " + std::to_string(p_producer) + ' ' + std::to_string(p_index);
+		return std::u8string{text.begin(), text.end()};
+	}
+
+	static std::array<core::os_string, files> make_names()
+	{
+		std::array<core::os_string, files> res;
+		for(uint32_t i = 0; i < files; ++i)
+		{
+			res[i] = std::filesystem::path{"file_" + std::to_string(i) + ".scef"}.native();
+		}
+		return res;
+	}
+} //namespace
+
+//producers store into line and column who they are and which of their messages it is,
+//the consumer drains while they run and checks that nothing is lost, reordered or torn
+TEST(Log_store, multi_producer)
+{
+	std::array<core::os_string, files> const names = make_names();
+	Log_store store;
+
+	std::atomic<uint32_t> running = producers;
+	std::vector<std::thread> threads;
+	for(uint32_t producer = 0; producer < producers; ++producer)
+	{
+		threads.emplace_back(
+			[&store, &names, &running, producer]()
+			{
+				for(uint32_t i = 0; i < messages; ++i)
+				{
+					store.push2log(names[i % files], producer, i, logger::Level::Warning, make_message(producer, i));
+				}
+				running.fetch_sub(1, std::memory_order_release);
+			});
+	}
+
+	std::vector<uint32_t> next(producers, 0);
+	std::array<core::os_char const*, files> interned{};
+	uint64_t drained = 0;
+	bool ordered  = true;
+	bool intact   = true;
+	bool shared   = true;
+	auto const consume =
+		[&](Log_store::record_t const& p_record)
+		{
+			ASSERT_LT(p_record.line, producers);
+			ordered = ordered && p_record.column == next[p_record.line];
+			next[p_record.line] = p_record.column + 1;
+
+			uint32_t const file = p_record.column % files;
+			intact = intact && p_record.file == names[file] && p_record.level == logger::Level::Warning
+				&& p_record.message == make_message(p_record.line, p_record.column);
+
+			//every record of the same file refers to the one interned name
+			if(interned[file] == nullptr)
+			{
+				interned[file] = p_record.file.data();
+			}
+			shared = shared && interned[file] == p_record.file.data();
+			++drained;
+		};
+
+	while(running.load(std::memory_order_acquire) != 0)
+	{
+		store.drain(consume);
+	}
+	for(std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	store.drain(consume);
+
+	EXPECT_EQ(drained, uint64_t{producers} * messages);
+	EXPECT_TRUE(ordered);
+	EXPECT_TRUE(intact);
+	EXPECT_TRUE(shared);
+	EXPECT_TRUE(store.empty());
+}
+
+TEST(Log_store, replay_and_clear)
+{
+	std::array<core::os_string, files> const names = make_names();
+	Log_store store;
+	Log_store target;
+	target.set_filter(logger::Level::Warning);
+
+	store.push2log(names[0], 1, 2, logger::Level::Info,    u8"dropped");
+	store.push2log(names[1], 3, 4, logger::Level::Warning, u8"kept");
+	store.replay(target);
+	EXPECT_TRUE(store.empty());
+
+	uintptr_t const count = target.drain(
+		[&names](Log_store::record_t const& p_record)
+		{
+			EXPECT_EQ(p_record.file, names[1]);
+			EXPECT_EQ(p_record.line, 3u);
+			EXPECT_EQ(p_record.column, 4u);
+			EXPECT_EQ(p_record.message, u8"kept");
+		});
+	EXPECT_EQ(count, 1u);
+
+	//names interned before the clear are gone, they must be interned again
+	store.clear();
+	store.push2log(names[2], 5, 6, logger::Level::Error, u8"after clear");
+	EXPECT_EQ(store.drain([&names](Log_store::record_t const& p_record) { EXPECT_EQ(p_record.file, names[2]); }), 1u);
+}